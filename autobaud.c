@@ -0,0 +1,108 @@
+// automatic baud rate detection
+//
+// license:     BSD
+
+#include "config.h"
+#ifdef CONFIG_AUTOBAUD
+
+#include <msp430.h>
+#include <inttypes.h>
+#include "cc.h"
+#include "clock.h"
+#include "uart_config.h"
+#include "uart_baud.h"
+#include "autobaud.h"
+
+#define    AB_TMR_CTL  CC_CONCAT_EXT_3(TA, AUTOBAUD_TA, CTL)
+#define   AB_TMR_CCTL  CC_CONCAT_EXT_2(CC_CONCAT_EXT_3(TA, AUTOBAUD_TA, CCTL), AUTOBAUD_CCR)
+#define    AB_TMR_CCR  CC_CONCAT_EXT_2(CC_CONCAT_EXT_3(TA, AUTOBAUD_TA, CCR), AUTOBAUD_CCR)
+
+// edges captured before the intervals are compared
+#define AB_EDGES  5
+
+uint32_t autobaud_measure(const uint16_t timeout)
+{
+    uint16_t edge[AB_EDGES];
+    uint16_t d, avg;
+    uint32_t span;
+    uint16_t ovf = 0;
+    uint8_t cnt = 0;
+    uint8_t c;
+    uint32_t ret = 0;
+
+    AB_TMR_CTL = TASSEL__SMCLK | MC__CONTINUOUS | TACLR;
+    AB_TMR_CCTL = CM_2 | AUTOBAUD_CCIS | SCS | CAP;
+
+    while (ovf < timeout) {
+        if (AB_TMR_CTL & TAIFG) {
+            AB_TMR_CTL &= ~TAIFG;
+            ovf++;
+        }
+
+        if (!(AB_TMR_CCTL & CCIFG)) {
+            continue;
+        }
+
+        if (AB_TMR_CCTL & COV) {
+            // an edge came in before the previous capture was read, so the
+            // intervals collected so far are wrong. start over
+            AB_TMR_CCTL &= ~(CCIFG | COV);
+            cnt = 0;
+            continue;
+        }
+
+        for (c = 0; c < AB_EDGES - 1; c++) {
+            edge[c] = edge[c + 1];
+        }
+        edge[AB_EDGES - 1] = AB_TMR_CCR;
+        AB_TMR_CCTL &= ~CCIFG;
+
+        if (++cnt < AB_EDGES) {
+            continue;
+        }
+
+        // the 4 intervals of 2 bit times each must be within 1/8 of their average
+        span = 0;
+        for (c = 1; c < AB_EDGES; c++) {
+            span += (uint16_t) (edge[c] - edge[c - 1]);
+        }
+        avg = span / (AB_EDGES - 1);
+        for (c = 1; c < AB_EDGES; c++) {
+            d = edge[c] - edge[c - 1];
+            if ((d > avg + (avg >> 3)) || (d < avg - (avg >> 3))) {
+                break;
+            }
+        }
+        if (c == AB_EDGES) {
+            // too few cycles per interval for this loop to be trusted, the
+            // rate is out of reach for the current SMCLK
+            if (avg >= AUTOBAUD_MIN_CYCLES) {
+                // span covers 2 * (AB_EDGES - 1) bit times
+                ret = (uint32_t) SMCLK_FREQ * 2 * (AB_EDGES - 1) / span;
+            }
+            break;
+        }
+    }
+
+    AB_TMR_CCTL = 0;
+    AB_TMR_CTL = MC__STOP | TACLR;
+
+    return ret;
+}
+
+uint8_t autobaud_get_id(const uint32_t baud)
+{
+    uint8_t id;
+    uint32_t rate;
+
+    for (id = BAUDRATE_9600; id <= BAUDRATE_460800; id++) {
+        rate = uart_baud_get_rate(id);
+        if ((baud > rate - rate / 25) && (baud < rate + rate / 25)) {
+            return id;
+        }
+    }
+
+    return 0;
+}
+
+#endif
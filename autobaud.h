@@ -0,0 +1,70 @@
+// automatic baud rate detection
+//
+// the remote end has to send a 0x55 character ('U'), optionally preceded by a break.
+// the falling edges on the RX line are timestamped by a Timer_A capture unit clocked
+// from SMCLK. 0x55 has a falling edge every two bit times (start bit and the four
+// zero data bits), so once four consecutive edge intervals agree the bit time is
+// known. a break or line noise only produces intervals that do not match and is
+// skipped. the detection is polled, no interrupt is used.
+//
+// the RX line has to reach the selected capture input, either because the RX pin
+// doubles as one (set the pin function accordingly) or via a jumper to a free
+// capture pin. define CONFIG_AUTOBAUD in config.h to enable this module.
+// the following can be overridden in config.h:
+//
+//   AUTOBAUD_TA     Timer_A instance to use (default 0)
+//   AUTOBAUD_CCR    capture/compare register (default 1)
+//   AUTOBAUD_CCIS   capture input select, CCIS_0 for CCIxA or CCIS_1 for CCIxB (default CCIS_0)
+//   AUTOBAUD_MIN_CYCLES  shortest edge interval accepted, in SMCLK cycles (default 64)
+//
+// the polling loop has to read every capture before the next edge arrives, so
+// the highest rate that can be measured is about 2 * SMCLK_FREQ / AUTOBAUD_MIN_CYCLES.
+// 230400 needs an SMCLK of at least 8MHz, 460800 at least 16MHz. faster
+// characters are rejected rather than reported with a wrong rate.
+//
+// license:     BSD
+
+#ifndef __AUTOBAUD_H__
+#define __AUTOBAUD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+#ifndef AUTOBAUD_TA
+#define AUTOBAUD_TA  0
+#endif
+
+#ifndef AUTOBAUD_CCR
+#define AUTOBAUD_CCR  1
+#endif
+
+#ifndef AUTOBAUD_CCIS
+#define AUTOBAUD_CCIS  CCIS_0
+#endif
+
+#ifndef AUTOBAUD_MIN_CYCLES
+#define AUTOBAUD_MIN_CYCLES  64
+#endif
+
+/*!
+	\brief measure the baud rate of a 0x55 character on the RX line
+    \details busy-waits until the character arrives or the timeout expires
+	\param timeout  in timer overflows, one overflow is 65536 SMCLK cycles
+	\return measured baud rate, or 0 on timeout or if the rate is too high for SMCLK
+*/
+uint32_t autobaud_measure(const uint16_t timeout);
+
+/*!
+	\brief find the standard rate closest to a measured one
+	\return one of the BAUDRATE_ constants from uart_config.h or 0 if none is within 4%
+*/
+uint8_t autobaud_get_id(const uint32_t baud);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -41,5 +41,7 @@
 
 #define CC_CONF_NORETURN __attribute__((__noreturn__))
 
+#define CC_CONF_BARRIER() __asm__ __volatile__("" : : : "memory")
+
 #endif /* __GNUC__ */
 #endif /* _CC_GCC_H_ */
@@ -139,6 +139,17 @@
 
 #define CC_ACCESS_NOW(type, variable) (*(volatile type *)&(variable))
 
+/** \def CC_BARRIER()
+ * Compiler memory barrier. Prevents the compiler from moving memory
+ * accesses (like a memcpy() into a buffer) across this point.
+ * It does not emit any instruction.
+ */
+#ifdef CC_CONF_BARRIER
+#define CC_BARRIER() CC_CONF_BARRIER()
+#else
+#define CC_BARRIER()
+#endif /* CC_CONF_BARRIER */
+
 #ifndef NULL
 #define NULL 0
 #endif /* NULL */
@@ -0,0 +1,207 @@
+// command line parser and dispatcher
+//
+// license:     BSD
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ringbuf.h"
+#include "cmd.h"
+
+static inline uint8_t cmd_is_sep(const char c)
+{
+    return (c == ' ') || (c == '\t') || (c == ',') || (c == '\n');
+}
+
+static inline int8_t cmd_hex_digit(const char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    } else if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    } else if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// convert a zero terminated token, returns EXIT_FAILURE on a malformed number
+static uint8_t cmd_parse_num(const char *str, const char type, union cmd_arg *arg)
+{
+    const char *p = str;
+    uint32_t val = 0;
+    uint8_t neg = 0;
+    uint8_t base = 10;
+    int8_t d;
+
+    if ((type == 'i') && (*p == '-')) {
+        neg = 1;
+        p++;
+    }
+    if ((p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X')) && (type != 'i')) {
+        base = 16;
+        p += 2;
+    } else if (type == 'x') {
+        base = 16;
+    }
+    if (!*p) {
+        return EXIT_FAILURE;
+    }
+
+    while (*p) {
+        d = cmd_hex_digit(*p);
+        if ((d < 0) || (d >= base)) {
+            return EXIT_FAILURE;
+        }
+        val = val * base + d;
+        p++;
+    }
+
+    if (type == 'i') {
+        arg->i = neg ? -(int32_t) val : (int32_t) val;
+    } else {
+        arg->u = val;
+    }
+    return EXIT_SUCCESS;
+}
+
+static const struct cmd *cmd_find(const struct cmd *table, const uint8_t count, const char *name)
+{
+    int16_t lo = 0, hi = count - 1, mid;
+    int r;
+
+    while (lo <= hi) {
+        mid = (lo + hi) >> 1;
+        r = strcmp(name, table[mid].name);
+        if (r == 0) {
+            return &table[mid];
+        } else if (r < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+uint8_t cmd_exec(const struct cmd *table, const uint8_t count, char *line, const uint16_t len)
+{
+    char *tok[CMD_MAX_ARGS + 1];
+    union cmd_arg argv[CMD_MAX_ARGS];
+    const struct cmd *c;
+    uint8_t ntok = 0;
+    uint8_t argc, i;
+    uint16_t p = 0;
+
+    // single pass, separators are overwritten with zeroes
+    while ((p < len) && line[p] && (line[p] != 0x0d)) {
+        if (cmd_is_sep(line[p])) {
+            line[p++] = 0;
+            continue;
+        }
+        if (ntok == CMD_MAX_ARGS + 1) {
+            return CMD_ERR_ARGS;
+        }
+        tok[ntok++] = &line[p];
+        while ((p < len) && line[p] && (line[p] != 0x0d) && !cmd_is_sep(line[p])) {
+            p++;
+        }
+    }
+    if (p == len) {
+        // there is no room for terminating the last token
+        return CMD_ERR_INCOMPLETE;
+    }
+    line[p] = 0;
+
+    if (!ntok) {
+        return CMD_ERR_EMPTY;
+    }
+
+    c = cmd_find(table, count, tok[0]);
+    if (c == NULL) {
+        return CMD_ERR_NOTFOUND;
+    }
+
+    argc = ntok - 1;
+    if ((argc < c->min_args) || (argc > strlen(c->spec))) {
+        return CMD_ERR_ARGS;
+    }
+
+    for (i = 0; i < argc; i++) {
+        if (c->spec[i] == 's') {
+            argv[i].s = tok[i + 1];
+        } else if (cmd_parse_num(tok[i + 1], c->spec[i], &argv[i]) != EXIT_SUCCESS) {
+            return CMD_ERR_ARGS;
+        }
+    }
+
+    return c->handler(argc, argv);
+}
+
+// a full ringbuf without a terminator can never complete the line since
+// the producer has no room left for the 0x0d. drop what is there
+static uint8_t cmd_ringbuf_incomplete(struct ringbuf *rb, const uint16_t elements, const uint16_t span_len)
+{
+    if (elements == rb->mask) {
+        ringbuf_consume(rb, span_len);
+        ringbuf_consume(rb, elements - span_len);
+        return CMD_ERR_OVERFLOW;
+    }
+
+    return CMD_ERR_INCOMPLETE;
+}
+
+uint8_t cmd_exec_ringbuf(const struct cmd *table, const uint8_t count, struct ringbuf *rb)
+{
+    char scratch[CMD_LINE_SZ];
+    uint8_t *span;
+    uint16_t span_len;
+    uint16_t elements;
+    uint16_t contiguous;
+    uint16_t i;
+    uint8_t ret;
+
+    // the producer may add bytes at any time, so work on a single snapshot of
+    // the element count and derive the span from it
+    elements = ringbuf_elements(rb);
+    ringbuf_read_span(rb, &span);
+    contiguous = (uint16_t) rb->mask + 1 - (span - rb->data);
+    span_len = (elements < contiguous) ? elements : contiguous;
+
+    // the common case, the whole line is contiguous in the ringbuf storage
+    for (i = 0; i < span_len; i++) {
+        if (span[i] == 0x0d) {
+            ret = cmd_exec(table, count, (char *)span, i + 1);
+            ringbuf_consume(rb, i + 1);
+            return ret;
+        }
+    }
+
+    // only a span that reaches the end of the storage continues at rb->data
+    if ((span_len < contiguous) || (elements == span_len)) {
+        return cmd_ringbuf_incomplete(rb, elements, span_len);
+    }
+
+    // the line wraps around the end of the buffer, look for the terminator in the rest
+    for (i = 0; i < elements - span_len; i++) {
+        if (rb->data[i] == 0x0d) {
+            break;
+        }
+    }
+    if (i == elements - span_len) {
+        return cmd_ringbuf_incomplete(rb, elements, span_len);
+    }
+
+    if (span_len + i < CMD_LINE_SZ) {
+        memcpy(scratch, span, span_len);
+        memcpy(scratch + span_len, rb->data, i);
+        scratch[span_len + i] = 0;
+        ret = cmd_exec(table, count, scratch, span_len + i + 1);
+    } else {
+        ret = CMD_ERR_OVERFLOW;
+    }
+    ringbuf_consume(rb, span_len);
+    ringbuf_consume(rb, i + 1);
+
+    return ret;
+}
@@ -0,0 +1,94 @@
+// command line parser and dispatcher
+//
+// a received line is split into tokens in a single pass. the separators are
+// overwritten with zeroes in place, so the tokens are not copied. the first
+// token is looked up by binary search in a const table of commands, and the
+// rest are converted according to the argument spec of the command before
+// its handler is called.
+//
+// the argument spec is a string with one character per argument:
+//   'u'   unsigned 32bit integer, decimal or hex with a 0x prefix
+//   'i'   signed 32bit integer, decimal
+//   'x'   unsigned 32bit integer, hex with or without a 0x prefix
+//   's'   string, argv[n].s points into the line
+//
+// the table has to be sorted by name in strcmp() order.
+//
+// example:
+//
+//   static const struct cmd cmds[] = {
+//       {"dump", "xu", 2, cmd_dump},    // dump 0x1000 64
+//       {"help", "", 0, cmd_help},
+//       {"set", "su", 1, cmd_set},      // set baud [115200]
+//   };
+//
+//   cmd_exec_ringbuf(cmds, 3, uart0_get_rx_ringbuf());
+//
+// license:     BSD
+
+#ifndef __CMD_H__
+#define __CMD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+#include "ringbuf.h"
+
+#ifndef CMD_MAX_ARGS
+#define CMD_MAX_ARGS  6
+#endif
+
+#ifndef CMD_LINE_SZ
+#define CMD_LINE_SZ  64         // scratch line for lines that wrap around the end of a ringbuf
+#endif
+
+// cmd_exec() return values, in addition to whatever the handler returns
+#define   CMD_ERR_NOTFOUND  0x80        // unknown command
+#define       CMD_ERR_ARGS  0x81        // wrong number of arguments or a malformed number
+#define      CMD_ERR_EMPTY  0x82        // the line holds no tokens
+#define CMD_ERR_INCOMPLETE  0x83        // the line is not terminated (yet)
+#define   CMD_ERR_OVERFLOW  0x84        // the line does not fit, it was dropped
+
+union cmd_arg {
+    uint32_t u;
+    int32_t i;
+    const char *s;
+};
+
+struct cmd {
+    const char *name;
+    const char *spec;           // argument spec, see above
+    uint8_t min_args;           // arguments past min_args are optional
+    uint8_t (*handler) (const uint8_t argc, const union cmd_arg * argv);
+};
+
+/*!
+	\brief tokenize and run a command line held in a linear buffer
+    \details the line is modified in place. it ends at the first 0 or 0x0d, which has to
+             be found within the first len bytes
+	\param table  commands sorted by name
+	\param count  number of entries in table
+	\param line   the line
+	\param len    size of the buffer holding the line
+	\return the handler's return value or one of the CMD_ERR_ codes
+*/
+uint8_t cmd_exec(const struct cmd *table, const uint8_t count, char *line, const uint16_t len);
+
+/*!
+	\brief run the next 0x0d terminated line in a ringbuf
+    \details the line is tokenized inside the ringbuf storage unless it wraps around the end
+             of the buffer, in which case it is copied into a CMD_LINE_SZ scratch buffer first.
+             the line and its terminator are removed from the ringbuf, unless CMD_ERR_INCOMPLETE
+             is returned. a wrapping line longer than CMD_LINE_SZ - 1, or a full ringbuf that
+             holds no terminator, is dropped and CMD_ERR_OVERFLOW is returned.
+	\return the handler's return value or one of the CMD_ERR_ codes
+*/
+uint8_t cmd_exec_ringbuf(const struct cmd *table, const uint8_t count, struct ringbuf *rb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+// shared handling of the DMA controller
+//
+// license:     BSD
+
+#include "config.h"
+#ifdef CONFIG_DMA
+
+#include <msp430.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include "driverlib.h"
+#include "dma.h"
+
+static uint8_t (*dma_irq_handler[DMA_CH_CNT]) (const uint8_t ch);
+
+void dma_set_irq_handler(const uint8_t ch, uint8_t (*handler) (const uint8_t ch))
+{
+    dma_irq_handler[ch] = handler;
+}
+
+void dma_set_trigger(const uint8_t ch, const uint8_t tsel)
+{
+    // DMACTL0 holds the triggers for channels 0 and 1, DMACTL1 for 2 and 3, etc
+    uint16_t addr = DMA_BASE + OFS_DMACTL0 + (ch >> 1) * 2;
+
+    if (ch & 1) {
+        HWREG16(addr) = (HWREG16(addr) & 0x00ff) | ((uint16_t) tsel << 8);
+    } else {
+        HWREG16(addr) = (HWREG16(addr) & 0xff00) | tsel;
+    }
+}
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=DMA_VECTOR
+__interrupt void DMA_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(DMA_VECTOR))) DMA_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    uint16_t iv = DMAIV;
+    uint8_t ch;
+
+    // DMAIV is 2 for channel 0, 4 for channel 1, etc. reading it clears the flag
+    if ((iv == 0) || (iv > DMA_CH_CNT * 2)) {
+        return;
+    }
+    ch = (iv >> 1) - 1;
+
+    if (dma_irq_handler[ch] != NULL) {
+        if (dma_irq_handler[ch](ch)) {
+            __bic_SR_register_on_exit(LPM4_bits);
+        }
+    }
+}
+
+#endif
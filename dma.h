@@ -0,0 +1,44 @@
+// shared handling of the DMA controller
+//
+// all DMA channels share a single interrupt vector, so drivers that use a channel
+// register a per-channel handler here instead of defining the ISR themselves.
+// define CONFIG_DMA in config.h to enable this module.
+//
+// license:     BSD
+
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+#ifndef DMA_CH_CNT
+#define DMA_CH_CNT  6           // number of channels (MSP430FR5994)
+#endif
+
+// access a register of channel ch, ofs is one of OFS_DMA0CTL, OFS_DMA0SA, OFS_DMA0DA, OFS_DMA0SZ
+#define DMA_REG16(ch, ofs)  HWREG16(DMA_BASE + ((ch) << 4) + (ofs))
+
+/*!
+	\brief set the handler that runs in the DMA ISR once channel ch has finished a block
+    \details the handler returns 1 if the main loop should be woken up. the channel needs DMAIE set
+	\param ch       channel number [0 .. DMA_CH_CNT-1]
+	\param handler  function called from the ISR, NULL disables the callback
+*/
+void dma_set_irq_handler(const uint8_t ch, uint8_t (*handler) (const uint8_t ch));
+
+/*!
+	\brief select the trigger source of a channel
+	\param ch    channel number [0 .. DMA_CH_CNT-1]
+	\param tsel  trigger number, see the 'DMA Trigger Assignments' table in the device datasheet
+*/
+void dma_set_trigger(const uint8_t ch, const uint8_t tsel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,7 +22,7 @@
 
 #ifdef __I2C_CONFIG_H__
 
-#include <stdio.h>
+#include "fmt.h"
 #include <stdlib.h>
 #include "glue.h"
 #include "ds3231.h"
@@ -93,7 +93,7 @@ t.year_s };
     pkg.options = I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     if (i2cm_transfer(&pkg) != I2C_ACK) {
         return EXIT_FAILURE;
@@ -121,7 +121,7 @@ uint8_t DS3231_get(const uint16_t usci_base_addr, struct ts * t)
     pkg.options = I2C_READ | I2C_LAST_NAK | I2C_REPEAT_SA_ON_READ;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     uint8_t rv = 255;
     rv = i2cm_transfer(&pkg);
@@ -172,7 +172,7 @@ uint8_t DS3231_set_addr(const uint16_t usci_base_addr, const uint8_t addr, const
     pkg.options = I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     if (i2cm_transfer(&pkg) != I2C_ACK) {
         return EXIT_FAILURE;
@@ -195,7 +195,7 @@ uint8_t DS3231_get_addr(const uint16_t usci_base_addr, const uint8_t addr, uint8
     pkg.options = I2C_READ | I2C_LAST_NAK | I2C_REPEAT_SA_ON_READ;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     uint8_t rv;
     rv = i2cm_transfer(&pkg);
@@ -281,7 +281,7 @@ uint8_t DS3231_get_treg(const uint16_t usci_base_addr, float *temp)
     pkg.options = I2C_READ | I2C_LAST_NAK | I2C_REPEAT_SA_ON_READ;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     uint8_t rv;
     rv = i2cm_transfer(&pkg);
@@ -335,7 +335,7 @@ uint8_t DS3231_set_a1(const uint16_t usci_base_addr,
     pkg.options = I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     if (i2cm_transfer(&pkg) != I2C_ACK) {
         return EXIT_FAILURE;
@@ -362,7 +362,7 @@ uint8_t DS3231_get_a1(const uint16_t usci_base_addr, char *buf, const uint8_t le
     pkg.options = I2C_READ | I2C_LAST_NAK | I2C_REPEAT_SA_ON_READ;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     uint8_t rv;
     rv = i2cm_transfer(&pkg);
@@ -379,7 +379,7 @@ uint8_t DS3231_get_a1(const uint16_t usci_base_addr, char *buf, const uint8_t le
     f[4] = (i2c_buff[3] & 0x40) >> 6;
     t[3] = bcd_to_dec(i2c_buff[3] & 0x3F);
 
-    snprintf(buf, len,
+    fmt_snprintf(buf, len,
              "s%02d m%02d h%02d d%02d fs%d m%d h%d d%d wm%d %d %d %d %d",
              t[0], t[1], t[2], t[3], f[0], f[1], f[2], f[3], f[4], i2c_buff[0],
              i2c_buff[1], i2c_buff[2], i2c_buff[3]);
@@ -444,7 +444,7 @@ uint8_t DS3231_set_a2(const uint16_t usci_base_addr,
     pkg.options = I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     if (i2cm_transfer(&pkg) != I2C_ACK) {
         return EXIT_FAILURE;
@@ -471,7 +471,7 @@ uint8_t DS3231_get_a2(const uint16_t usci_base_addr, char *buf, const uint8_t le
     pkg.options = I2C_READ | I2C_LAST_NAK | I2C_REPEAT_SA_ON_READ;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     uint8_t rv;
     rv = i2cm_transfer(&pkg);
@@ -488,7 +488,7 @@ uint8_t DS3231_get_a2(const uint16_t usci_base_addr, char *buf, const uint8_t le
     f[3] = (i2c_buff[2] & 0x40) >> 6;
     t[2] = bcd_to_dec(i2c_buff[2] & 0x3F);
 
-    snprintf(buf, len, "m%02d h%02d d%02d fm%d h%d d%d wm%d %d %d %d", t[0],
+    fmt_snprintf(buf, len, "m%02d h%02d d%02d fm%d h%d d%d wm%d %d %d %d", t[0],
              t[1], t[2], f[0], f[1], f[2], f[3], i2c_buff[0], i2c_buff[1],
              i2c_buff[2]);
 
@@ -0,0 +1,271 @@
+// software timers delivered through the event handler
+//
+// every wheel slot holds a doubly linked list (by index) of the timers that expire
+// on it, each timer also counts how many full wheel revolutions it still has to wait.
+// the lists are shared with the ISR, so they are only changed with interrupts disabled.
+//
+// license:     BSD
+
+#include "config.h"
+#ifdef CONFIG_EH_TIMER
+
+#include <msp430.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include "cc.h"
+#include "event_handler.h"
+#include "eh_timer.h"
+
+#ifndef EH_TIMER_EVID
+#error "EH_TIMER_EVID not defined in config.h"
+#endif
+
+#if EH_TIMER_MAX > 32
+#error "EH_TIMER_MAX can be at most 32"
+#endif
+
+#define  EH_TIMER_WHEEL_SZ  (1 << EH_TIMER_WHEEL_BITS)
+#define EH_TIMER_WHEEL_MSK  (EH_TIMER_WHEEL_SZ - 1)
+
+#define         EH_TMR_CTL  CC_CONCAT_EXT_3(TA, EH_TIMER_TA, CTL)
+#define       EH_TMR_CCTL0  CC_CONCAT_EXT_3(TA, EH_TIMER_TA, CCTL0)
+#define        EH_TMR_CCR0  CC_CONCAT_EXT_3(TA, EH_TIMER_TA, CCR0)
+#define      EH_TMR_VECTOR  CC_CONCAT_EXT_3(TIMER, EH_TIMER_TA, _A0_VECTOR)
+
+#define    EH_TMR_UNUSED  0x0
+#define    EH_TMR_ACTIVE  0x1   // linked into the wheel
+#define   EH_TMR_EXPIRED  0x2   // waiting to be dispatched
+
+struct eh_timer {
+    void (*callback) (const uint8_t id);
+    uint16_t period;            // 0 for one-shot timers
+    uint16_t rounds;            // wheel revolutions left
+    uint8_t next;
+    uint8_t prev;
+    uint8_t slot;
+    uint8_t state;
+};
+
+static struct eh_timer tmr[EH_TIMER_MAX];
+static uint8_t wheel[EH_TIMER_WHEEL_SZ];        // head of the list for every slot
+static uint8_t tmr_free;        // head of the list of unused timers
+static uint8_t tmr_active;      // number of timers linked into the wheel
+static volatile uint8_t cursor;
+static volatile uint32_t tmr_expired;
+
+static inline uint8_t eh_timer_ctz(const uint32_t val)
+{
+#ifdef __GNUC__
+    return __builtin_ctzl(val);
+#else
+    uint8_t b = 0;
+
+    while (!(val & ((uint32_t) 1 << b))) {
+        b++;
+    }
+    return b;
+#endif
+}
+
+// interrupts must be disabled
+static void eh_timer_list_add(const uint8_t id, const uint16_t ticks)
+{
+    struct eh_timer *t = &tmr[id];
+
+    t->slot = (cursor + ticks) & EH_TIMER_WHEEL_MSK;
+    t->rounds = (ticks - 1) >> EH_TIMER_WHEEL_BITS;
+    t->prev = EH_TIMER_INVALID;
+    t->next = wheel[t->slot];
+    if (t->next != EH_TIMER_INVALID) {
+        tmr[t->next].prev = id;
+    }
+    wheel[t->slot] = id;
+}
+
+// interrupts must be disabled
+static void eh_timer_list_del(const uint8_t id)
+{
+    struct eh_timer *t = &tmr[id];
+
+    if (t->prev != EH_TIMER_INVALID) {
+        tmr[t->prev].next = t->next;
+    } else {
+        wheel[t->slot] = t->next;
+    }
+    if (t->next != EH_TIMER_INVALID) {
+        tmr[t->next].prev = t->prev;
+    }
+}
+
+// interrupts must be disabled
+static void eh_timer_link(const uint8_t id, const uint16_t ticks)
+{
+    eh_timer_list_add(id, ticks);
+    tmr[id].state |= EH_TMR_ACTIVE;
+
+    if (!tmr_active++) {
+        // first active timer, start ticking
+        EH_TMR_CCTL0 = CCIE;
+        EH_TMR_CTL = TASSEL__ACLK | MC__UP | TACLR;
+    }
+}
+
+// interrupts must be disabled
+static void eh_timer_unlink(const uint8_t id)
+{
+    eh_timer_list_del(id);
+    tmr[id].state &= ~EH_TMR_ACTIVE;
+
+    if (!--tmr_active) {
+        // nothing left to wait for, let the CPU sleep undisturbed
+        EH_TMR_CTL = MC__STOP;
+        EH_TMR_CCTL0 = 0;
+    }
+}
+
+static void eh_timer_release(const uint8_t id)
+{
+    tmr[id].state = EH_TMR_UNUSED;
+    tmr[id].next = tmr_free;
+    tmr_free = id;
+}
+
+static void eh_timer_dispatch(const uint32_t evid)
+{
+    uint32_t expired;
+    uint8_t id;
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    expired = tmr_expired;
+    tmr_expired = 0;
+    __set_interrupt_state(state);
+
+    while (expired) {
+        id = eh_timer_ctz(expired);
+        expired &= expired - 1;
+
+        __disable_interrupt();
+        if (!(tmr[id].state & EH_TMR_EXPIRED)) {
+            // cancelled in the meantime by a previous callback
+            __set_interrupt_state(state);
+            continue;
+        }
+        tmr[id].state &= ~EH_TMR_EXPIRED;
+        if (tmr[id].state == EH_TMR_UNUSED) {
+            // one-shot timer, the id can be reused by the callback itself
+            eh_timer_release(id);
+        }
+        __set_interrupt_state(state);
+
+        tmr[id].callback(id);
+    }
+}
+
+void eh_timer_init(void)
+{
+    uint8_t c;
+
+    for (c = 0; c < EH_TIMER_WHEEL_SZ; c++) {
+        wheel[c] = EH_TIMER_INVALID;
+    }
+
+    tmr_free = EH_TIMER_INVALID;
+    for (c = EH_TIMER_MAX; c > 0; c--) {
+        eh_timer_release(c - 1);
+    }
+
+    tmr_active = 0;
+    cursor = 0;
+    tmr_expired = 0;
+
+    EH_TMR_CTL = MC__STOP;
+    EH_TMR_CCTL0 = 0;
+    EH_TMR_CCR0 = EH_TIMER_TICK - 1;
+
+    eh_register(eh_timer_dispatch, EH_TIMER_EVID);
+}
+
+uint8_t eh_timer_start(void (*callback) (const uint8_t id), const uint16_t ticks, const uint8_t periodic)
+{
+    uint8_t id;
+    uint16_t state;
+    uint16_t delay = ticks ? ticks : 1;
+
+    // the free list is also taken from when a timer is started inside an ISR
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    id = tmr_free;
+    if (id != EH_TIMER_INVALID) {
+        tmr_free = tmr[id].next;
+        tmr[id].callback = callback;
+        tmr[id].period = periodic ? delay : 0;
+        eh_timer_link(id, delay);
+    }
+    __set_interrupt_state(state);
+
+    return id;
+}
+
+uint8_t eh_timer_cancel(const uint8_t id)
+{
+    uint16_t state;
+
+    if ((id >= EH_TIMER_MAX) || (tmr[id].state == EH_TMR_UNUSED)) {
+        return EXIT_FAILURE;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    if (tmr[id].state & EH_TMR_ACTIVE) {
+        eh_timer_unlink(id);
+    }
+    tmr_expired &= ~((uint32_t) 1 << id);
+    eh_timer_release(id);
+    __set_interrupt_state(state);
+
+    return EXIT_SUCCESS;
+}
+
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EH_TMR_VECTOR
+__interrupt void eh_timer_isr(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EH_TMR_VECTOR))) eh_timer_isr(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    uint8_t id, next;
+    uint32_t expired = 0;
+    struct eh_timer *t;
+
+    cursor = (cursor + 1) & EH_TIMER_WHEEL_MSK;
+
+    for (id = wheel[cursor]; id != EH_TIMER_INVALID; id = next) {
+        t = &tmr[id];
+        next = t->next;
+        if (t->rounds) {
+            t->rounds--;
+            continue;
+        }
+        if (t->period) {
+            // re-armed at the head of a list, so it is not visited again in this tick
+            eh_timer_list_del(id);
+            eh_timer_list_add(id, t->period);
+        } else {
+            eh_timer_unlink(id);
+        }
+        t->state |= EH_TMR_EXPIRED;
+        expired |= (uint32_t) 1 << id;
+    }
+
+    if (expired) {
+        tmr_expired |= expired;
+        eh_post(EH_TIMER_EVID);
+        __bic_SR_register_on_exit(LPM4_bits);
+    }
+}
+
+#endif
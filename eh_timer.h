@@ -0,0 +1,76 @@
+// software timers delivered through the event handler
+//
+// a hashed timer wheel driven by the CCR0 interrupt of a Timer_A instance clocked from ACLK.
+// starting, cancelling and expiring a timer are O(1) operations, the ISR only walks the
+// timers that hash into the current wheel slot. expired timers are handed over to the main
+// loop via eh_post(EH_TIMER_EVID) and their callbacks are run from eh_exec(), never from
+// the ISR. the tick interrupt is turned off while no timer is active, so the CPU can stay in
+// LPM3 between deadlines.
+//
+// define CONFIG_EH_TIMER to enable this module. the following are set in config.h:
+//
+//   EH_TIMER_EVID         event bit used to signal expired timers (mandatory, no default)
+//   EH_TIMER_TA           Timer_A instance to use (default 1, TA1 CCR0)
+//   EH_TIMER_TICK         tick period in ACLK cycles (default 33, about 1ms)
+//   EH_TIMER_MAX          number of timers (default 8, max 32)
+//   EH_TIMER_WHEEL_BITS   log2 of the number of wheel slots (default 4)
+//
+// license:     BSD
+
+#ifndef __EH_TIMER_H__
+#define __EH_TIMER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+#ifndef EH_TIMER_TA
+#define EH_TIMER_TA  1
+#endif
+
+#ifndef EH_TIMER_TICK
+#define EH_TIMER_TICK  33
+#endif
+
+#ifndef EH_TIMER_MAX
+#define EH_TIMER_MAX  8
+#endif
+
+#ifndef EH_TIMER_WHEEL_BITS
+#define EH_TIMER_WHEEL_BITS  4
+#endif
+
+#define EH_TIMER_INVALID  0xff
+
+/*!
+	\brief initialize the timer wheel
+    \details sets up the Timer_A instance and registers the expiry dispatcher with eh_register()
+             for EH_TIMER_EVID. must be called after eh_init()
+*/
+void eh_timer_init(void);
+
+/*!
+	\brief start a software timer
+    \details can also be called from an ISR, the callback still runs from the main loop
+	\param callback  function run from the main loop once the timer expires, it gets the timer id
+	\param ticks     delay in EH_TIMER_TICK units [1 .. 65535]
+	\param periodic  if non-zero the timer is restarted with the same delay after every expiry
+	\return timer id or EH_TIMER_INVALID if all timers are in use
+	\sa eh_timer_cancel
+*/
+uint8_t eh_timer_start(void (*callback) (const uint8_t id), const uint16_t ticks, const uint8_t periodic);
+
+/*!
+	\brief stop a timer
+    \details also discards an expiry that was not yet dispatched
+	\return EXIT_SUCCESS or EXIT_FAILURE if the id is not an active timer
+*/
+uint8_t eh_timer_cancel(const uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
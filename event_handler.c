@@ -1,53 +1,199 @@
 
 // an event handler linked list that facilitates running callbacks in the main loop after a triggered interrupt
 //
-// two different implementations are provided, one that uses malloc() for dynamic allocation of nodes in the list
-// and another that simply manages an array EH_MAX long of event_handler structures. the CONFIG_DYN_ALLOC define
-// switches between them.
+// two different implementations are provided, one that allocates the nodes of a linked list out of a fixed
+// block pool of EH_MAX entries and another that simply manages an array EH_MAX long of event_handler structures.
+// the CONFIG_DYN_ALLOC define switches between them.
+//
+// if CONFIG_EH_BIT_DISPATCH is defined (array implementation only), eh_register() also maintains
+// a table with the set of handlers for each of the 32 event bits. eh_exec() then only visits the
+// bits that are set in the event instead of testing every registered handler. in this mode the
+// handlers are run in registration order, which eh_unregister_*() preserves.
+//
+// ISRs can also hand events over via eh_post(), which sets the bits in a global pending mask.
+// the main loop then only has to call eh_dispatch_pending() in a loop, which runs the handlers
+// for all pending events (in priority order if eh_set_priority() was used) and enters a low
+// power mode only when no event is pending.
+//
+// if CONFIG_EH_PROFILE is defined, eh_exec() also records how many times every callback was
+// run and how many timer cycles it took in total and in the worst case.
+//
+// with CONFIG_EH_STATIC handlers can also be registered at link time via EH_REGISTER_STATIC().
 //
 // author:      Petre Rodan <2b4eda@subdimension.ro>
 // license:     BSD
 
+#include <msp430.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include "event_handler.h"
+#include "pool.h"
+#ifdef CONFIG_EH_PROFILE
+#include "helper.h"
+#endif
 
 #ifdef CONFIG_DYN_ALLOC
 static struct event_handler *evh;
+static struct event_handler *evh_tail;
+static struct pool evh_pool;
+static POOL_MEM(evh_pool_mem, sizeof(struct event_handler), EH_MAX);
 #else
 static struct event_handler evh[EH_MAX];
 int8_t event_trail;             // the last populated event struct in the evh array
 #endif
 
+#if defined(CONFIG_EH_BIT_DISPATCH) && !defined(CONFIG_DYN_ALLOC)
+
+#if EH_MAX > 32
+#error "CONFIG_EH_BIT_DISPATCH supports at most 32 handlers (EH_MAX)"
+#elif EH_MAX > 16
+typedef uint32_t eh_set_t;
+#elif EH_MAX > 8
+typedef uint16_t eh_set_t;
+#else
+typedef uint8_t eh_set_t;
+#endif
+
+// for each of the 32 event bits, the set of evh[] slots that have to run on it
+static eh_set_t eh_bit_table[32];
+
+static inline uint8_t eh_ctz(const uint32_t val)
+{
+#ifdef __GNUC__
+    return __builtin_ctzl(val);
+#else
+    uint8_t b = 0;
+
+    while (!(val & ((uint32_t) 1 << b))) {
+        b++;
+    }
+    return b;
+#endif
+}
+
+static void eh_bit_table_add(const int8_t slot)
+{
+    uint32_t bits = evh[slot].evid;
+
+    while (bits) {
+        eh_bit_table[eh_ctz(bits)] |= (eh_set_t) 1 << slot;
+        bits &= bits - 1;
+    }
+}
+
+static void eh_bit_table_rebuild(void)
+{
+    int8_t c;
+
+    memset(eh_bit_table, 0, sizeof(eh_bit_table));
+    for (c = 0; c <= event_trail; c++) {
+        eh_bit_table_add(c);
+    }
+}
+
+#endif
+
 struct event_handler *event_handler_getp(void)
 {
     return evh;
 }
 
+static inline void eh_exec_static(const uint32_t event)
+{
+#ifdef CONFIG_EH_STATIC
+    const struct event_handler *p;
+
+    // handlers placed in the eh_table section by EH_REGISTER_STATIC().
+    // both symbols are NULL if the section is empty
+    if (!__start_eh_table || !__stop_eh_table) {
+        return;
+    }
+    for (p = __start_eh_table; p < __stop_eh_table; p++) {
+        if (event & p->evid) {
+            p->callback(event);
+        }
+    }
+#endif
+}
+
+#ifdef CONFIG_EH_PROFILE
+// upper word of the profiling time, counted by the timer overflow interrupt
+static volatile uint16_t eh_prof_ovf;
+
+// 32bit profiling time. an overflow that happened right before the timer was read
+// may not have been counted by the interrupt yet, the pending flag covers for it
+static uint32_t eh_profile_time(void)
+{
+    uint16_t state;
+    uint16_t hi, lo;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    hi = eh_prof_ovf;
+    lo = EH_PROFILE_TIMER_READ();
+    if (EH_PROFILE_TIMER_OVF_PENDING() && (lo < 0x8000)) {
+        hi++;
+    }
+    __set_interrupt_state(state);
+
+    return ((uint32_t) hi << 16) | lo;
+}
+#endif
+
+static inline void eh_run(struct event_handler *p, const uint32_t event)
+{
+#ifdef CONFIG_EH_PROFILE
+    uint32_t start, cycles;
+
+    start = eh_profile_time();
+    p->callback(event);
+    cycles = eh_profile_time() - start;
+
+    p->prof_cnt++;
+    p->prof_total += cycles;
+    if (cycles > p->prof_max) {
+        p->prof_max = cycles;
+    }
+#else
+    p->callback(event);
+#endif
+}
+
 #ifdef CONFIG_DYN_ALLOC
 
 void eh_init(void)
 {
-
+    pool_init(&evh_pool, evh_pool_mem, sizeof(struct event_handler), EH_MAX);
+    evh = NULL;
+    evh_tail = NULL;
 }
 
 uint8_t eh_register(void (*callback) (const uint32_t evid), const uint32_t evid)
 {
-    struct event_handler **p = &evh;
+    struct event_handler *p;
 
-    while (*p) {
-        p = &(*p)->next;
+    if (!evh_pool.bsize) {
+        // projects that never call eh_init() get the pool set up here
+        eh_init();
     }
 
-    *p = (struct event_handler *)malloc(sizeof(struct event_handler));
+    p = (struct event_handler *)pool_alloc(&evh_pool);
 
-    if (*p == NULL) {
+    if (p == NULL) {
         return EXIT_FAILURE;
     }
-    (*p)->next = NULL;
-    (*p)->callback = callback;
-    (*p)->evid = evid;
+    p->next = NULL;
+    p->callback = callback;
+    p->evid = evid;
+
+    // append to the tail so that handlers run in registration order
+    if (evh_tail) {
+        evh_tail->next = p;
+    } else {
+        evh = p;
+    }
+    evh_tail = p;
     return EXIT_SUCCESS;
 }
 
@@ -64,6 +210,9 @@ uint8_t eh_unregister_callback(void (*callback) (const uint32_t evid))
             } else {
                 pp->next = p->next;
             }
+            if (p == evh_tail) {
+                evh_tail = pp;
+            }
             rm = p;
         } else {
             pp = p;
@@ -71,7 +220,7 @@ uint8_t eh_unregister_callback(void (*callback) (const uint32_t evid))
         p = p->next;
 
         if (rm) {
-            free(rm);
+            pool_free(&evh_pool, rm);
             ret = EXIT_SUCCESS;
         }
     }
@@ -92,6 +241,9 @@ uint8_t eh_unregister_event(const uint32_t evid)
             } else {
                 pp->next = p->next;
             }
+            if (p == evh_tail) {
+                evh_tail = pp;
+            }
             rm = p;
         } else {
             pp = p;
@@ -99,7 +251,7 @@ uint8_t eh_unregister_event(const uint32_t evid)
         p = p->next;
 
         if (rm) {
-            free(rm);
+            pool_free(&evh_pool, rm);
             ret = EXIT_SUCCESS;
         }
     }
@@ -111,22 +263,42 @@ void eh_exec(const uint32_t event)
 {
     struct event_handler *p = evh;
 
+    eh_exec_static(event);
+
     while (p) {
         // run the callback function if it's registered for the current event
         if (event & p->evid) {
-            p->callback(event);
+            eh_run(p, event);
         }
         p = p->next;
     }
 }
 
 #else
-// same, but don't use malloc()
+// same, but use a plain array instead of a linked list
+
+// close the gap left by slot c. the profiling counters move along with their handler
+static void eh_slot_remove(const int8_t c)
+{
+    if (c != event_trail) {
+#ifdef CONFIG_EH_BIT_DISPATCH
+        // the entries above move down one slot to keep the registration order
+        memmove(&evh[c], &evh[c + 1], sizeof(struct event_handler) * (event_trail - c));
+#else
+        evh[c] = evh[event_trail];
+#endif
+    }
+    memset(&evh[event_trail], 0, sizeof(struct event_handler));
+    event_trail--;
+}
 
 void eh_init(void)
 {
     event_trail = -1;
     memset(evh, 0, sizeof(struct event_handler) * EH_MAX);
+#ifdef CONFIG_EH_BIT_DISPATCH
+    memset(eh_bit_table, 0, sizeof(eh_bit_table));
+#endif
 }
 
 uint8_t eh_register(void (*callback) (const uint32_t evid), const uint32_t evid)
@@ -137,6 +309,9 @@ uint8_t eh_register(void (*callback) (const uint32_t evid), const uint32_t evid)
     event_trail++;
     evh[event_trail].callback = callback;
     evh[event_trail].evid = evid;
+#ifdef CONFIG_EH_BIT_DISPATCH
+    eh_bit_table_add(event_trail);
+#endif
 
     return EXIT_SUCCESS;
 }
@@ -148,17 +323,17 @@ uint8_t eh_unregister_callback(void (*callback) (const uint32_t evid))
 
     for (c = event_trail; c > -1; c--) {
         if (evh[c].callback == callback) {
-            if (c != event_trail) {
-                evh[c].callback = evh[event_trail].callback;
-                evh[c].evid = evh[event_trail].evid;
-            }
-            evh[event_trail].callback = NULL;
-            evh[event_trail].evid = 0;
-            event_trail--;
+            eh_slot_remove(c);
             ret = EXIT_SUCCESS;
         }
     }
 
+#ifdef CONFIG_EH_BIT_DISPATCH
+    if (ret == EXIT_SUCCESS) {
+        eh_bit_table_rebuild();
+    }
+#endif
+
     return ret;
 }
 
@@ -169,31 +344,188 @@ uint8_t eh_unregister_event(const uint32_t evid)
 
     for (c = event_trail; c > -1; c--) {
         if (evh[c].evid == evid) {
-            if (c != event_trail) {
-                evh[c].callback = evh[event_trail].callback;
-                evh[c].evid = evh[event_trail].evid;
-            }
-            evh[event_trail].callback = NULL;
-            evh[event_trail].evid = 0;
-            event_trail--;
+            eh_slot_remove(c);
             ret = EXIT_SUCCESS;
         }
     }
 
+#ifdef CONFIG_EH_BIT_DISPATCH
+    if (ret == EXIT_SUCCESS) {
+        eh_bit_table_rebuild();
+    }
+#endif
+
     return ret;
 }
 
+#ifdef CONFIG_EH_BIT_DISPATCH
+void eh_exec(const uint32_t event)
+{
+    uint32_t bits = event;
+    eh_set_t run = 0;
+    uint8_t c;
+
+    eh_exec_static(event);
+
+    // collect the handlers registered for any of the set bits
+    while (bits) {
+        run |= eh_bit_table[eh_ctz(bits)];
+        bits &= bits - 1;
+    }
+
+    // each handler is run only once, even if it matches several bits
+    while (run) {
+        c = eh_ctz(run);
+        eh_run(&evh[c], event);
+        run &= run - 1;
+    }
+}
+#else
 void eh_exec(const uint32_t event)
 {
     int8_t c;
 
+    eh_exec_static(event);
+
     for (c = event_trail; c > -1; c--) {
         if (event & evh[c].evid) {
             // run the callback function if it's registered for the current event
-            evh[c].callback(event);
+            eh_run(&evh[c], event);
+        }
+    }
+}
+#endif
+
+#endif
+
+static volatile uint32_t eh_pending;
+static const uint32_t *eh_prio;
+static uint8_t eh_prio_cnt;
+
+void eh_post(const uint32_t evid)
+{
+    uint16_t state;
+
+    // a 32bit OR is not atomic on the msp430
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    eh_pending |= evid;
+    __set_interrupt_state(state);
+}
+
+void eh_set_priority(const uint32_t *masks, const uint8_t count)
+{
+    eh_prio = masks;
+    eh_prio_cnt = masks ? count : 0;
+}
+
+void eh_dispatch_pending(const uint16_t lpm_bits)
+{
+    uint32_t ev, sel;
+    uint8_t c;
+
+    while (1) {
+        __disable_interrupt();
+        ev = eh_pending;
+        if (!ev) {
+            // GIE and the LPM bits are set by the same instruction, so an ISR
+            // that posts an event after the check above will wake us up
+            __bis_SR_register(lpm_bits | GIE);
+            __no_operation();
+            return;
+        }
+
+        // pick the highest priority group that has pending events
+        sel = ev;
+        for (c = 0; c < eh_prio_cnt; c++) {
+            if (ev & eh_prio[c]) {
+                sel = ev & eh_prio[c];
+                break;
+            }
         }
+        eh_pending &= ~sel;
+        __enable_interrupt();
+
+        eh_exec(sel);
     }
 }
 
+#ifdef CONFIG_EH_PROFILE
+
+void eh_profile_init(void)
+{
+    eh_prof_ovf = 0;
+    EH_PROFILE_TIMER_INIT();
+    eh_profile_reset();
+}
+
+void eh_profile_timer_overflow(void)
+{
+    eh_prof_ovf++;
+}
+
+#ifdef EH_PROFILE_TIMER_TB0
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=TIMER0_B1_VECTOR
+__interrupt void eh_profile_timer_isr(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(TIMER0_B1_VECTOR))) eh_profile_timer_isr(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    // the profiler owns Timer_B0, only its overflow interrupt is enabled
+    if (TB0IV == TBIV__TBIFG) {
+        eh_prof_ovf++;
+    }
+}
 #endif
 
+void eh_profile_reset(void)
+{
+#ifdef CONFIG_DYN_ALLOC
+    struct event_handler *p;
+
+    for (p = evh; p; p = p->next) {
+#else
+    struct event_handler *p;
+    int8_t c;
+
+    for (c = 0; c <= event_trail; c++) {
+        p = &evh[c];
+#endif
+        p->prof_cnt = 0;
+        p->prof_total = 0;
+        p->prof_max = 0;
+    }
+}
+
+void eh_profile_report(uint16_t (*print) (const char *str))
+{
+    char itoa_buf[CONV_BASE_10_BUF_SZ];
+    struct event_handler *p;
+#ifdef CONFIG_DYN_ALLOC
+
+    for (p = evh; p; p = p->next) {
+#else
+    int8_t c;
+
+    for (c = 0; c <= event_trail; c++) {
+        p = &evh[c];
+#endif
+        // cb 0x5c1a ev 0x08 n 120 tot 45210 max 812
+        print("cb ");
+        print(_utoh(itoa_buf, (uintptr_t) p->callback));
+        print(" ev ");
+        print(_utoh(itoa_buf, p->evid));
+        print(" n ");
+        print(_utoa(itoa_buf, p->prof_cnt));
+        print(" tot ");
+        print(_utoa(itoa_buf, p->prof_total));
+        print(" max ");
+        print(_utoa(itoa_buf, p->prof_max));
+        print("\r\n");
+    }
+}
+
+#endif
@@ -1,8 +1,23 @@
 // an event handler linked list that facilitates running callbacks in the main loop after a triggered interrupt
 //
-// two different implementations are provided, one that uses malloc() for dynamic allocation of nodes in the list
-// and another that simply manages an array EH_MAX long of event_handler structures. the CONFIG_DYN_ALLOC define
-// switches between them.
+// two different implementations are provided, one that allocates the nodes of a linked list out of a fixed
+// block pool of EH_MAX entries and another that simply manages an array EH_MAX long of event_handler structures.
+// the CONFIG_DYN_ALLOC define switches between them.
+//
+// if CONFIG_EH_BIT_DISPATCH is defined (array implementation only), eh_register() also maintains
+// a table with the set of handlers for each of the 32 event bits. eh_exec() then only visits the
+// bits that are set in the event instead of testing every registered handler. in this mode the
+// handlers are run in registration order, which eh_unregister_*() preserves.
+//
+// ISRs can also hand events over via eh_post(), which sets the bits in a global pending mask.
+// the main loop then only has to call eh_dispatch_pending() in a loop, which runs the handlers
+// for all pending events (in priority order if eh_set_priority() was used) and enters a low
+// power mode only when no event is pending.
+//
+// if CONFIG_EH_PROFILE is defined, eh_exec() also records how many times every callback was
+// run and how many timer cycles it took in total and in the worst case.
+//
+// with CONFIG_EH_STATIC handlers can also be registered at link time via EH_REGISTER_STATIC().
 //
 // author:      Petre Rodan <2b4eda@subdimension.ro>
 // license:     BSD
@@ -37,12 +52,42 @@ struct event_handler {
     void (*callback) (const uint32_t evid);
     /*! bitfield of triggers for which the function should be run */
     uint32_t evid;
+#ifdef CONFIG_EH_PROFILE
+    /*! number of times the callback was run */
+    uint32_t prof_cnt;
+    /*! total number of profiling timer cycles spent in the callback */
+    uint32_t prof_total;
+    /*! worst case number of profiling timer cycles spent in the callback */
+    uint32_t prof_max;
+#endif
 #ifdef CONFIG_DYN_ALLOC
     /*! pointer to the next node in the list */
     struct event_handler *next;
 #endif
 };
 
+#ifdef CONFIG_EH_STATIC
+
+/*!
+	\brief register an event handler at link time
+    \details places a const struct event_handler into the eh_table section, which ends up in
+             FRAM next to .rodata. eh_exec() runs these handlers before the ones added via
+             eh_register(), they cost no SRAM and no startup time and can not be unregistered.
+             GNU ld provides the __start_eh_table and __stop_eh_table symbols for the section,
+             a custom linker script must keep the section, ex. eh_table : { KEEP(*(eh_table)) } > FRAM
+             usage at file scope: EH_REGISTER_STATIC(rtc, rtc_handler, SYS_EVH_RTC);
+             static handlers are not profiled
+*/
+#define EH_REGISTER_STATIC(name, cb, ev) \
+    static const struct event_handler eh_static_##name \
+    __attribute__ ((used, section("eh_table"))) = { .callback = cb, .evid = ev }
+
+// weak, ld only defines them if at least one EH_REGISTER_STATIC() entry is linked in
+extern const struct event_handler __start_eh_table[] __attribute__ ((weak));
+extern const struct event_handler __stop_eh_table[] __attribute__ ((weak));
+
+#endif
+
 /*!
 	\brief get pointer to the event handler structure
 	\details get pointer to the head of the event handler linked list
@@ -52,7 +97,9 @@ struct event_handler * event_handler_getp(void);
 
 /*!
 	\brief initialize the array of event handler structures
-    \details zeroes out the array of the event handler structs. only needed for the non-malloc implementation
+    \details zeroes out the array of the event handler structs or initializes the node pool. must be called
+             before eh_register() in the array implementation. with CONFIG_DYN_ALLOC the first eh_register()
+             initializes the pool if eh_init() was never called
 	\sa event_handler, eh_register
 */
 void eh_init(void);
@@ -60,6 +107,7 @@ void eh_init(void);
 /*!
 	\brief register a new event
 	\details add a node to the event handler linked list
+	\return EXIT_SUCCESS, or EXIT_FAILURE if all EH_MAX slots or pool blocks are taken
 	\sa event_handler, eh_init, eh_unregister_callback, eh_unregister_event
 */
 uint8_t eh_register(
@@ -90,12 +138,91 @@ uint8_t eh_unregister_event(const uint32_t evid);
 */
 void eh_exec(const uint32_t event);
 
-#ifndef CONFIG_DYN_ALLOC
+/*!
+	\brief mark events as pending
+    \details atomically ORs evid into the pending mask. can be called from an ISR or from the main loop.
+             an ISR also has to wake up the main loop, see EH_POST_ISR()
+	\sa eh_dispatch_pending
+*/
+void eh_post(const uint32_t evid);
+
+/*!
+	\brief post an event from an ISR and leave the low power mode once the ISR returns
+    \details must be used directly inside the interrupt function
+*/
+#define EH_POST_ISR(evid) do { eh_post(evid); __bic_SR_register_on_exit(LPM4_bits); } while (0)
+
+/*!
+	\brief set the order in which pending events are dispatched
+    \details masks is an array of count event masks, highest priority first. pending events
+             that are not part of any mask are dispatched after all of them. the array is not
+             copied, so it must stay valid. NULL reverts to dispatching all pending events at once
+	\sa eh_dispatch_pending
+*/
+void eh_set_priority(const uint32_t *masks, const uint8_t count);
+
+/*!
+	\brief run the handlers for all pending events, then sleep
+    \details pending events are cleared and passed to eh_exec() one priority group at a time.
+             the pending mask is checked again after every group, so a freshly posted high priority
+             event overtakes lower priority ones. once nothing is pending the CPU enters the low
+             power mode given in lpm_bits (ex. LPM3_bits) with interrupts enabled. the check and
+             the entry into the low power mode are done with interrupts disabled, so an event
+             posted in between can not be missed. the function returns after the next wakeup
+             and is meant to be called repeatedly from the main loop
+	\sa eh_post, eh_set_priority
+*/
+void eh_dispatch_pending(const uint16_t lpm_bits);
 
 #ifndef EH_MAX
-#define EH_MAX  8 // event handler array size
+#define EH_MAX  8 // event handler array/pool size
+#endif
+
+#ifdef CONFIG_EH_PROFILE
+
+// free-running 16bit timer used to measure the callbacks. the defaults use Timer_B0
+// clocked from SMCLK, its overflow interrupt extends the count to 32bit so callbacks
+// longer than 65535 cycles are reported correctly. all three macros can be overridden
+// in proj.h, ex. with a stub when the accounting is tested on a host machine. another
+// timer needs its overflow interrupt to call eh_profile_timer_overflow()
+#ifndef EH_PROFILE_TIMER_INIT
+#define EH_PROFILE_TIMER_TB0
+#define EH_PROFILE_TIMER_INIT() do { TB0CTL = TBSSEL__SMCLK | MC__CONTINUOUS | TBCLR | TBIE; } while (0)
 #endif
 
+#ifndef EH_PROFILE_TIMER_READ
+#define EH_PROFILE_TIMER_READ() TB0R
+#endif
+
+// true while an overflow has happened that the interrupt has not counted yet
+#ifndef EH_PROFILE_TIMER_OVF_PENDING
+#define EH_PROFILE_TIMER_OVF_PENDING() (TB0CTL & TBIFG)
+#endif
+
+/*!
+	\brief start the profiling timer and clear all counters
+	\sa eh_profile_report
+*/
+void eh_profile_init(void);
+
+/*!
+	\brief clear the counters of all registered handlers
+*/
+void eh_profile_reset(void);
+
+/*!
+	\brief count one overflow of the profiling timer
+    \details only needed if EH_PROFILE_TIMER_INIT() selects a timer other than the default Timer_B0,
+             to be called from the overflow interrupt of that timer
+*/
+void eh_profile_timer_overflow(void);
+
+/*!
+	\brief print one line per registered handler with its invocation count, total and worst case cycles
+    \details ex. eh_profile_report(uart0_print);
+*/
+void eh_profile_report(uint16_t (*print) (const char *str));
+
 #endif
 
 #ifdef __cplusplus
@@ -32,8 +32,10 @@ uint32_t FM24_read(const uint16_t usci_base_addr, const uint8_t slave_addr, uint
 {
     uint32_t c_addr;
     uint8_t i2c_buff[2];
-    i2c_package_t pkg;
-#ifndef HARDWARE_I2C
+    i2c_package_t pkg[2];
+#ifdef HARDWARE_I2C
+    i2c_transfer_t t;
+#else
     uint8_t rv = EXIT_FAILURE;
 #endif
 
@@ -50,32 +52,37 @@ uint32_t FM24_read(const uint16_t usci_base_addr, const uint8_t slave_addr, uint
     i2c_buff[0] = (c_addr & 0xff00) >> 8;
     i2c_buff[1] = c_addr & 0xff;
 
-    pkg.slave_addr = slave_addr | (c_addr >> 16);
-    pkg.addr = NULL;
-    pkg.addr_len = 0;
-    pkg.data = i2c_buff;
-    pkg.data_len = 2;
-    pkg.options = I2C_WRITE;
+    pkg[0].slave_addr = slave_addr | (c_addr >> 16);
+    pkg[0].addr = NULL;
+    pkg[0].addr_len = 0;
+    pkg[0].data = i2c_buff;
+    pkg[0].data_len = 2;
+    pkg[0].options = I2C_WRITE;
+
+    // * and now do the actual read
+    pkg[1].slave_addr = pkg[0].slave_addr;
+    pkg[1].addr = NULL;
+    pkg[1].addr_len = 0;
+    pkg[1].data = data;
+    pkg[1].data_len = data_len;
+    pkg[1].options = I2C_READ | I2C_LAST_NAK;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    // both packages are sent as a single transaction
+    t.pkg = pkg;
+    t.pkg_cnt = 2;
+    t.callback = NULL;
+    if (i2c_transfer_run(usci_base_addr, &t) != I2C_IDLE) {
+        return EXIT_FAILURE;
+    }
 #else
-    rv = i2cm_transfer(&pkg);
+    rv = i2cm_transfer(&pkg[0]);
 
     if (rv != I2C_ACK) {
         return EXIT_FAILURE;
     }
-#endif
 
-    // * and now do the actual read
-    pkg.data = data;
-    pkg.data_len = data_len;
-    pkg.options = I2C_READ | I2C_LAST_NAK;
-
-#ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
-#else
-    rv = i2cm_transfer(&pkg);
+    rv = i2cm_transfer(&pkg[1]);
     if (rv != I2C_ACK) {
         return EXIT_FAILURE;
     }
@@ -115,7 +122,7 @@ uint32_t FM24_write(const uint16_t usci_base_addr, const uint8_t slave_addr, uin
     pkg.options = I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     rv = i2cm_transfer(&pkg);
     if (rv != I2C_ACK) {
@@ -149,7 +156,7 @@ uint8_t FM24_sleep(const uint16_t usci_base_addr, const uint8_t slave_addr)
     pkg.options = I2C_NO_ADDR_SHIFT | I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     rv = i2cm_transfer(&pkg);
     if (rv != I2C_ACK) {
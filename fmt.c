@@ -0,0 +1,246 @@
+// minimal printf-style formatter that writes into a sink callback
+//
+// license:     BSD
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "helper.h"
+#include "fmt.h"
+
+#define FMT_LEFT  0x1
+#define FMT_ZERO  0x2
+
+#define FMT_Q_DEFAULT_PREC  2
+
+struct fmt_buf {
+    char *buf;
+    uint16_t size;
+    uint16_t pos;
+};
+
+static const uint32_t fmt_pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+    100000000, 1000000000
+};
+
+static uint16_t fmt_pad(fmt_sink_t sink, void *ctx, const char c, int16_t cnt)
+{
+    uint16_t ret = 0;
+
+    while (cnt-- > 0) {
+        sink(ctx, &c, 1);
+        ret++;
+    }
+    return ret;
+}
+
+// output a converted field. sign is 0 or the character that goes in front of the digits
+static uint16_t fmt_field(fmt_sink_t sink, void *ctx, const char sign, const char *str,
+                          const uint16_t len, const uint8_t width, const uint8_t flags)
+{
+    uint16_t ret = 0;
+    int16_t pad = (int16_t) width - len - (sign ? 1 : 0);
+
+    if (!(flags & (FMT_LEFT | FMT_ZERO))) {
+        ret += fmt_pad(sink, ctx, ' ', pad);
+    }
+    if (sign) {
+        sink(ctx, &sign, 1);
+        ret++;
+    }
+    if (flags & FMT_ZERO) {
+        ret += fmt_pad(sink, ctx, '0', pad);
+    }
+    sink(ctx, str, len);
+    ret += len;
+    if (flags & FMT_LEFT) {
+        ret += fmt_pad(sink, ctx, ' ', pad);
+    }
+    return ret;
+}
+
+uint16_t fmt_vprintf(fmt_sink_t sink, void *ctx, const char *format, va_list ap)
+{
+    char itoa_buf[CONV_BASE_10_BUF_SZ];
+    char q_buf[CONV_BASE_10_BUF_SZ * 2];
+    const char *p = format;
+    const char *lit;
+    const char *str;
+    char *s;
+    char sign;
+    char c;
+    uint8_t flags, width, prec, is_long;
+    uint32_t uval;
+    int32_t ival;
+    uint16_t len;
+    uint16_t ret = 0;
+
+    while (*p) {
+        // literal text is handed over in one go
+        lit = p;
+        while (*p && (*p != '%')) {
+            p++;
+        }
+        if (p != lit) {
+            sink(ctx, lit, p - lit);
+            ret += p - lit;
+        }
+        if (!*p) {
+            break;
+        }
+        p++;
+
+        flags = 0;
+        width = 0;
+        prec = FMT_Q_DEFAULT_PREC;
+        is_long = 0;
+        sign = 0;
+
+        while ((*p == '-') || (*p == '0')) {
+            flags |= (*p == '-') ? FMT_LEFT : FMT_ZERO;
+            p++;
+        }
+        if (flags & FMT_LEFT) {
+            flags &= ~FMT_ZERO;
+        }
+        while ((*p >= '0') && (*p <= '9')) {
+            width = width * 10 + (*p - '0');
+            p++;
+        }
+        if (*p == '.') {
+            p++;
+            prec = 0;
+            while ((*p >= '0') && (*p <= '9')) {
+                prec = prec * 10 + (*p - '0');
+                p++;
+            }
+            if (prec > 9) {
+                prec = 9;
+            }
+        }
+        if (*p == 'l') {
+            is_long = 1;
+            p++;
+        }
+
+        switch (*p) {
+        case 'd':
+        case 'i':
+        case 'q':
+            ival = is_long ? va_arg(ap, int32_t) : va_arg(ap, int);
+            if (ival < 0) {
+                sign = '-';
+                uval = -(uint32_t) ival;
+            } else {
+                uval = ival;
+            }
+            if (*p == 'q') {
+                // integer part, the decimal point and the zero padded fractional part
+                str = _utoa(itoa_buf, uval / fmt_pow10[prec]);
+                len = strlen(str);
+                memcpy(q_buf, str, len);
+                if (prec) {
+                    q_buf[len++] = '.';
+                    s = prepend_padding(itoa_buf, _utoa(itoa_buf, uval % fmt_pow10[prec]),
+                                        PAD_ZEROES, prec);
+                    memcpy(q_buf + len, s, prec);
+                    len += prec;
+                }
+                ret += fmt_field(sink, ctx, sign, q_buf, len, width, flags);
+            } else {
+                str = _utoa(itoa_buf, uval);
+                ret += fmt_field(sink, ctx, sign, str, strlen(str), width, flags);
+            }
+            break;
+        case 'u':
+            uval = is_long ? va_arg(ap, uint32_t) : va_arg(ap, unsigned int);
+            str = _utoa(itoa_buf, uval);
+            ret += fmt_field(sink, ctx, 0, str, strlen(str), width, flags);
+            break;
+        case 'x':
+        case 'X':
+            uval = is_long ? va_arg(ap, uint32_t) : va_arg(ap, unsigned int);
+            s = _utorh(itoa_buf, uval, 1);
+            str = s;
+            if (*p == 'x') {
+                for (; *s; s++) {
+                    if (*s > '9') {
+                        *s |= 0x20;
+                    }
+                }
+            }
+            ret += fmt_field(sink, ctx, 0, str, strlen(str), width, flags);
+            break;
+        case 's':
+            str = va_arg(ap, const char *);
+            if (str == NULL) {
+                str = "(null)";
+            }
+            ret += fmt_field(sink, ctx, 0, str, strlen(str), width, flags & ~FMT_ZERO);
+            break;
+        case 'c':
+            c = (char)va_arg(ap, int);
+            ret += fmt_field(sink, ctx, 0, &c, 1, width, flags & ~FMT_ZERO);
+            break;
+        case '%':
+            sink(ctx, p, 1);
+            ret++;
+            break;
+        case 0:
+            // format ends in the middle of a conversion
+            return ret;
+        default:
+            // unknown conversion, print it as is
+            sink(ctx, p - 1, 2);
+            ret += 2;
+            break;
+        }
+        p++;
+    }
+
+    return ret;
+}
+
+uint16_t fmt_printf(fmt_sink_t sink, void *ctx, const char *format, ...)
+{
+    va_list ap;
+    uint16_t ret;
+
+    va_start(ap, format);
+    ret = fmt_vprintf(sink, ctx, format, ap);
+    va_end(ap);
+    return ret;
+}
+
+static void fmt_buf_sink(void *ctx, const char *str, const uint16_t len)
+{
+    struct fmt_buf *b = (struct fmt_buf *)ctx;
+    uint16_t cnt = len;
+
+    if (b->pos + cnt > b->size - 1) {
+        cnt = b->size - 1 - b->pos;
+    }
+    memcpy(b->buf + b->pos, str, cnt);
+    b->pos += cnt;
+}
+
+uint16_t fmt_snprintf(char *buf, const uint16_t size, const char *format, ...)
+{
+    struct fmt_buf b;
+    va_list ap;
+
+    if (size == 0) {
+        return 0;
+    }
+    b.buf = buf;
+    b.size = size;
+    b.pos = 0;
+
+    va_start(ap, format);
+    fmt_vprintf(fmt_buf_sink, &b, format, ap);
+    va_end(ap);
+
+    buf[b.pos] = 0;
+    return b.pos;
+}
@@ -0,0 +1,51 @@
+// minimal printf-style formatter that writes into a sink callback
+//
+// supported conversions: %d %i %u %x %X %s %c %q %%
+//   flags      '-' left justify, '0' pad with zeroes
+//   width      minimum field width
+//   'l'        the argument is 32bit (long) instead of int
+//   %q         fixed point, prints a signed integer divided by 10^precision.
+//              precision is set via '.N' and defaults to 2, so ("%q", 1234) prints 12.34
+//
+// the numeric conversions are done by the helper.c routines, no buffer is allocated
+// for the whole output and the libc stdio functions are not used.
+//
+// license:     BSD
+
+#ifndef __FMT_H__
+#define __FMT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+#include <stdarg.h>
+
+/*!
+	\brief output callback
+	\param ctx  opaque pointer handed over to fmt_printf()
+	\param str  characters to output, not zero terminated
+	\param len  number of characters
+*/
+typedef void (*fmt_sink_t) (void *ctx, const char *str, const uint16_t len);
+
+/*!
+	\brief format a string into a sink
+	\return number of characters handed to the sink
+*/
+uint16_t fmt_vprintf(fmt_sink_t sink, void *ctx, const char *format, va_list ap);
+uint16_t fmt_printf(fmt_sink_t sink, void *ctx, const char *format, ...);
+
+/*!
+	\brief format a string into a buffer
+    \details the output is truncated to size-1 characters and always zero terminated
+	\return number of characters written, not counting the terminating zero
+*/
+uint16_t fmt_snprintf(char *buf, const uint16_t size, const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
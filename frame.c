@@ -0,0 +1,159 @@
+// framed binary transport, COBS encoding with a CRC16 trailer
+//
+// license:     BSD
+
+#include <inttypes.h>
+#include <string.h>
+#include "ringbuf.h"
+#include "frame.h"
+
+// CRC16-CCITT, one nibble at a time
+static const uint16_t frame_crc_tbl[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+static inline uint16_t frame_crc16_byte(uint16_t crc, const uint8_t c)
+{
+    crc = (crc << 4) ^ frame_crc_tbl[(crc >> 12) ^ (c >> 4)];
+    crc = (crc << 4) ^ frame_crc_tbl[(crc >> 12) ^ (c & 0xf)];
+    return crc;
+}
+
+uint16_t frame_crc16(uint16_t crc, const uint8_t * data, const uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        crc = frame_crc16_byte(crc, data[i]);
+    }
+    return crc;
+}
+
+// emit the code byte and the data of the current block
+static void frame_enc_flush(struct frame_enc *e)
+{
+    uint8_t code = e->blen + 1;
+
+    e->sink(e->ctx, &code, 1);
+    if (e->blen) {
+        e->sink(e->ctx, e->blk, e->blen);
+    }
+    e->blen = 0;
+}
+
+static void frame_enc_cobs(struct frame_enc *e, const uint8_t * data, const uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        if (data[i] == 0) {
+            frame_enc_flush(e);
+        } else {
+            e->blk[e->blen++] = data[i];
+            if (e->blen == FRAME_COBS_BLOCK) {
+                // a full block is not followed by an implicit zero
+                frame_enc_flush(e);
+            }
+        }
+    }
+}
+
+void frame_enc_begin(struct frame_enc *e, frame_sink_t sink, void *ctx)
+{
+    e->sink = sink;
+    e->ctx = ctx;
+    e->crc = 0xffff;
+    e->blen = 0;
+}
+
+void frame_enc_write(struct frame_enc *e, const uint8_t * data, const uint16_t len)
+{
+    e->crc = frame_crc16(e->crc, data, len);
+    frame_enc_cobs(e, data, len);
+}
+
+void frame_enc_end(struct frame_enc *e)
+{
+    uint8_t trailer[2];
+
+    trailer[0] = e->crc >> 8;
+    trailer[1] = e->crc & 0xff;
+    frame_enc_cobs(e, trailer, 2);
+    frame_enc_flush(e);
+    trailer[0] = 0;
+    e->sink(e->ctx, trailer, 1);
+}
+
+static void frame_dec_reset(struct frame_dec *d)
+{
+    d->len = 0;
+    d->crc = 0xffff;
+    d->code = 0;
+    d->remaining = 0;
+    d->overflow = 0;
+}
+
+void frame_dec_init(struct frame_dec *d, uint8_t * buf, const uint16_t size)
+{
+    d->buf = buf;
+    d->size = size;
+    frame_dec_reset(d);
+}
+
+static inline void frame_dec_out(struct frame_dec *d, const uint8_t c)
+{
+    if (d->len < d->size) {
+        d->buf[d->len++] = c;
+        d->crc = frame_crc16_byte(d->crc, c);
+    } else {
+        d->overflow = 1;
+    }
+}
+
+int16_t frame_dec_ringbuf(struct frame_dec *d, struct ringbuf *rb)
+{
+    uint8_t *span;
+    uint16_t span_len;
+    uint16_t i;
+    uint8_t c;
+    int16_t ret;
+
+    while ((span_len = ringbuf_read_span(rb, &span))) {
+        for (i = 0; i < span_len; i++) {
+            c = span[i];
+
+            if (c == 0) {
+                // end of frame
+                ringbuf_consume(rb, i + 1);
+                if (d->overflow) {
+                    ret = FRAME_ERR_OVERFLOW;
+                } else if (d->remaining || (d->len < 2)) {
+                    ret = FRAME_ERR_FORMAT;
+                } else if (d->crc) {
+                    // the CRC over the payload and its trailer leaves a zero remainder
+                    ret = FRAME_ERR_CRC;
+                } else {
+                    ret = d->len - 2;
+                }
+                frame_dec_reset(d);
+                return ret;
+            }
+
+            if (d->remaining) {
+                frame_dec_out(d, c);
+                d->remaining--;
+            } else {
+                // a new block, the previous one was followed by a zero unless it was full
+                if (d->code && (d->code != 0xff)) {
+                    frame_dec_out(d, 0);
+                }
+                d->code = c;
+                d->remaining = c - 1;
+            }
+        }
+        ringbuf_consume(rb, span_len);
+    }
+
+    return FRAME_ERR_INCOMPLETE;
+}
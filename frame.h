@@ -0,0 +1,98 @@
+// framed binary transport, COBS encoding with a CRC16 trailer
+//
+// a frame on the wire is the COBS encoded payload followed by its CRC16
+// (CCITT, poly 0x1021, init 0xffff, big endian) and a single 0x00 delimiter.
+// COBS removes every zero from the encoded data, so the delimiter always marks
+// a frame boundary and the receiver can resynchronize after any error. the
+// overhead is one byte per 254 bytes of payload plus 4 bytes per frame.
+//
+// the encoder streams, the payload can be handed over in any number of chunks
+// and the output is passed to a sink callback (uart0_tx_sink() for the uart0
+// TX ring buffer). only the current COBS block (at most 254 bytes) is held back
+// until its length is known. the decoder reads straight out of the RX ring
+// buffer spans and writes the payload into a buffer supplied by the caller.
+//
+// license:     BSD
+
+#ifndef __FRAME_H__
+#define __FRAME_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+#include "ringbuf.h"
+
+#define     FRAME_COBS_BLOCK  254
+
+// frame_dec_ringbuf() return values, a non-negative value is the payload length
+#define   FRAME_ERR_INCOMPLETE  -1  // no delimiter received yet
+#define          FRAME_ERR_CRC  -2
+#define     FRAME_ERR_OVERFLOW  -3  // the payload does not fit into the buffer
+#define       FRAME_ERR_FORMAT  -4  // malformed COBS data or a frame too short for a CRC
+
+typedef void (*frame_sink_t) (void *ctx, const uint8_t * data, const uint16_t len);
+
+struct frame_enc {
+    frame_sink_t sink;
+    void *ctx;
+    uint16_t crc;
+    uint8_t blen;
+    uint8_t blk[FRAME_COBS_BLOCK];
+};
+
+struct frame_dec {
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t len;
+    uint16_t crc;
+    uint8_t code;               // code byte of the current block
+    uint8_t remaining;          // data bytes left in the current block
+    uint8_t overflow;
+};
+
+/*!
+	\brief calculate a CRC16-CCITT
+	\param crc  0xffff for a new calculation or the result of the previous call
+*/
+uint16_t frame_crc16(uint16_t crc, const uint8_t * data, const uint16_t len);
+
+/*!
+	\brief start a new frame
+	\param sink  output function
+	\param ctx   opaque pointer handed to the sink
+*/
+void frame_enc_begin(struct frame_enc *e, frame_sink_t sink, void *ctx);
+
+/*!
+	\brief add payload to the current frame
+*/
+void frame_enc_write(struct frame_enc *e, const uint8_t * data, const uint16_t len);
+
+/*!
+	\brief append the CRC and the delimiter and flush the frame to the sink
+*/
+void frame_enc_end(struct frame_enc *e);
+
+/*!
+	\brief prepare the decoder
+	\param buf   storage for the decoded payload and the CRC
+	\param size  size of buf, must be at least the maximum payload length + 2
+*/
+void frame_dec_init(struct frame_dec *d, uint8_t * buf, const uint16_t size);
+
+/*!
+	\brief decode the data available in a ring buffer
+    \details consumes bytes up to and including the next delimiter. bytes left over
+             after a delimiter stay in the ring buffer for the next call
+	\return payload length, FRAME_ERR_INCOMPLETE if more data is needed or another FRAME_ERR_ code.
+	        the decoder is ready for the next frame after any return value other than FRAME_ERR_INCOMPLETE
+*/
+int16_t frame_dec_ringbuf(struct frame_dec *d, struct ringbuf *rb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
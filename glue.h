@@ -4,11 +4,22 @@
 #include "clock.h"
 
 #include "uart_config.h"
+#include "uart_baud.h"
+#include "autobaud.h"
 
 #include "uart0.h"
+#include "uart.h"
 #include "helper.h"
+#include "fmt.h"
+#include "cmd.h"
+#include "frame.h"
+#include "trace.h"
 #include "event_handler.h"
+#include "eh_timer.h"
 #include "ringbuf.h"
+#include "recqueue.h"
+#include "pool.h"
+#include "dma.h"
 
 #include "spi.h"
 #include "ad7789.h"
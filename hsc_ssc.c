@@ -58,7 +58,7 @@ uint8_t HSC_SSC_read(const uint16_t usci_base_addr, const uint8_t slave_addr, st
     pkg.options = I2C_READ | I2C_LAST_NAK | I2C_REPEAT_SA_ON_READ;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     rv = i2cm_transfer(&pkg);
 
@@ -1,4 +1,5 @@
 
+#include <stdlib.h>
 #include "driverlib.h"
 #include "config.h"
 #include "i2c.h"
@@ -8,106 +9,535 @@ typedef enum {
     SM_WRITE_DATA,
     SM_SEND_RESTART,
     SM_READ_DATA,
-    SM_DONE
+    SM_DONE,
+    SM_NACKED                   // the package was NACKed, waiting for the STOP to get through
 } i2c_state_t;
 
-volatile static struct {
-    i2c_package_t *pkg;
-    uint16_t idx;
-    void (*callback) (i2c_status_t result);
-    i2c_status_t status;
-    i2c_state_t next_state;
-} transfer;
+// how the STOP at the end of a package is generated
+typedef enum {
+    STOP_AUTO,                  // UCASTPx = 10, by the hardware once UCBxTBCNT bytes went through
+    STOP_CNTIFG,                // UCASTPx = 01, by the ISR on UCBCNTIFG during the last byte
+    STOP_MANUAL                 // UCASTPx = 00, by the ISR one byte before the end
+} i2c_stop_t;
 
 #ifdef IRQ_I2C
+#include "recqueue.h"
 #include "i2c_internal.h"
+#ifdef I2C_USES_DMA
+#include "dma.h"
+#endif
 
 //////////////////////////////////////////////////
 // interrupt controlled i2c implementation
 // needs a configured i2c_config.h in the source dir
 // see the i2c_config.TEMPLATE.h file for guidance
+//
+// transactions are kept in a queue and the ISR moves from one package to the
+// next and from one transaction to the next on its own. the main loop only
+// needs to wake up for the completion callbacks.
+//
+// every eUSCI_B instance enabled with I2C_USES_UCBx has its own queue, state
+// and ISR, so transactions on different buses run concurrently. the API
+// functions pick the instance by the base address they are handed.
+
+#ifndef I2C_QUEUE_SZ
+#define I2C_QUEUE_SZ  8
+#endif
+
+struct i2c_bus {
+    uint16_t base;              // EUSCI_Bx_BASE
+    i2c_transfer_t *xfer;       // transaction in progress
+    i2c_package_t *pkg;         // package in progress
+    uint8_t pkg_idx;            // next package of xfer
+    uint16_t idx;
+    volatile i2c_status_t status;
+    i2c_state_t next_state;
+    i2c_stop_t stop;
+#ifdef I2C_USES_DMA
+    uint8_t dma_ch;             // I2C_NO_DMA if the instance does not use a channel
+    uint8_t dma_rx_tsel;
+    uint8_t dma_tx_tsel;
+#endif
+    struct recq q;
+    i2c_transfer_t *q_mem[I2C_QUEUE_SZ];
+    i2c_transfer_t start_xfer;  // single package transaction used by i2c_transfer_start()
+    void (*start_cb) (i2c_status_t result);
+};
+
+#ifdef I2C_USES_DMA
+// the DMA channel moves the data phase of packages of at least I2C_DMA_MIN bytes,
+// triggered by UCBxRXIFG0/UCBxTXIFG0. the ISR keeps the address phase and the STOP.
+#ifndef CONFIG_DMA
+#error "I2C_USES_DMA needs CONFIG_DMA"
+#endif
+
+#if defined(I2C_DMA_CH) || defined(I2C_DMA_RX_TSEL) || defined(I2C_DMA_TX_TSEL)
+#error "I2C_DMA_CH and I2C_DMA_xX_TSEL are now set per instance, see I2C_UCBx_DMA_CH in i2c_config.TEMPLATE.h"
+#endif
+
+#ifndef I2C_DMA_MIN
+#define I2C_DMA_MIN  16
+#endif
+
+#if I2C_DMA_MIN < 2
+#error "I2C_DMA_MIN must be at least 2"
+#endif
+
+#define I2C_NO_DMA  0xff
+
+#ifdef I2C_UCB0_DMA_CH
+#if !defined(I2C_UCB0_DMA_RX_TSEL) || !defined(I2C_UCB0_DMA_TX_TSEL)
+#define I2C_UCB0_DMA_RX_TSEL  18        // UCB0RXIFG0, see 'DMA Trigger Assignments' in the datasheet
+#define I2C_UCB0_DMA_TX_TSEL  19        // UCB0TXIFG0
+#endif
+#else
+#define I2C_UCB0_DMA_CH  I2C_NO_DMA
+#define I2C_UCB0_DMA_RX_TSEL  0
+#define I2C_UCB0_DMA_TX_TSEL  0
+#endif
+
+#ifdef I2C_UCB1_DMA_CH
+#if !defined(I2C_UCB1_DMA_RX_TSEL) || !defined(I2C_UCB1_DMA_TX_TSEL)
+#error "define I2C_UCB1_DMA_RX_TSEL and I2C_UCB1_DMA_TX_TSEL for the selected DMA channel"
+#endif
+#else
+#define I2C_UCB1_DMA_CH  I2C_NO_DMA
+#define I2C_UCB1_DMA_RX_TSEL  0
+#define I2C_UCB1_DMA_TX_TSEL  0
+#endif
+
+#ifdef I2C_UCB2_DMA_CH
+#if !defined(I2C_UCB2_DMA_RX_TSEL) || !defined(I2C_UCB2_DMA_TX_TSEL)
+#error "define I2C_UCB2_DMA_RX_TSEL and I2C_UCB2_DMA_TX_TSEL for the selected DMA channel"
+#endif
+#else
+#define I2C_UCB2_DMA_CH  I2C_NO_DMA
+#define I2C_UCB2_DMA_RX_TSEL  0
+#define I2C_UCB2_DMA_TX_TSEL  0
+#endif
+
+#ifdef I2C_UCB3_DMA_CH
+#if !defined(I2C_UCB3_DMA_RX_TSEL) || !defined(I2C_UCB3_DMA_TX_TSEL)
+#error "define I2C_UCB3_DMA_RX_TSEL and I2C_UCB3_DMA_TX_TSEL for the selected DMA channel"
+#endif
+#else
+#define I2C_UCB3_DMA_CH  I2C_NO_DMA
+#define I2C_UCB3_DMA_RX_TSEL  0
+#define I2C_UCB3_DMA_TX_TSEL  0
+#endif
+
+#define I2C_BUS_INIT(n, b) { .base = (b), .dma_ch = I2C_UCB##n##_DMA_CH, \
+        .dma_rx_tsel = I2C_UCB##n##_DMA_RX_TSEL, .dma_tx_tsel = I2C_UCB##n##_DMA_TX_TSEL }
+#else
+#define I2C_BUS_INIT(n, b) { .base = (b) }
+#endif
+
+#ifdef I2C_USES_UCB0
+static struct i2c_bus i2c_b0 = I2C_BUS_INIT(0, EUSCI_B0_BASE);
+#endif
+#ifdef I2C_USES_UCB1
+static struct i2c_bus i2c_b1 = I2C_BUS_INIT(1, EUSCI_B1_BASE);
+#endif
+#ifdef I2C_USES_UCB2
+static struct i2c_bus i2c_b2 = I2C_BUS_INIT(2, EUSCI_B2_BASE);
+#endif
+#ifdef I2C_USES_UCB3
+static struct i2c_bus i2c_b3 = I2C_BUS_INIT(3, EUSCI_B3_BASE);
+#endif
+
+static struct i2c_bus *const i2c_buses[] = {
+#ifdef I2C_USES_UCB0
+    &i2c_b0,
+#endif
+#ifdef I2C_USES_UCB1
+    &i2c_b1,
+#endif
+#ifdef I2C_USES_UCB2
+    &i2c_b2,
+#endif
+#ifdef I2C_USES_UCB3
+    &i2c_b3,
+#endif
+};
+
+#define I2C_BUS_CNT  (sizeof(i2c_buses) / sizeof(i2c_buses[0]))
+
+// returns NULL if the instance is not enabled in i2c_config.h
+static struct i2c_bus *i2c_bus_get(const uint16_t base_addr)
+{
+    uint8_t i;
+
+    for (i = 0; i < I2C_BUS_CNT; i++) {
+        if (i2c_buses[i]->base == base_addr) {
+            return i2c_buses[i];
+        }
+    }
+    return NULL;
+}
+
+#ifdef I2C_USES_DMA
+static uint8_t i2c_dma_handler(const uint8_t ch);
 
+// hand the data phase of the current package over to the DMA channel.
+// a write expects the first byte to be already in TXBUF.
+// with an automatic STOP the package simply ends with UCSTPIFG. otherwise a
+// read leaves its last byte to the ISR so the STOP can be scheduled in time and
+// the DMA interrupt hands control back to the ISR.
+static void i2c_dma_start(struct i2c_bus *bus, const uint8_t rx)
+{
+    uint16_t ctl = DMADT_0 | DMASRCBYTE | DMADSTBYTE | DMAEN;
+    uint16_t len = bus->pkg->data_len - 1;
+    uint8_t ch = bus->dma_ch;
+
+    if (bus->stop != STOP_AUTO) {
+        ctl |= DMAIE;
+    } else if (rx) {
+        len++;
+    }
+
+    DMA_REG16(ch, OFS_DMA0CTL) = 0;
+    if (rx) {
+        dma_set_trigger(ch, bus->dma_rx_tsel);
+        DMA_REG16(ch, OFS_DMA0SA) = bus->base + OFS_UCBxRXBUF;
+        DMA_REG16(ch, OFS_DMA0DA) = (uintptr_t) bus->pkg->data;
+        DMA_REG16(ch, OFS_DMA0SZ) = len;
+        DMA_REG16(ch, OFS_DMA0CTL) = ctl | DMASRCINCR_0 | DMADSTINCR_3;
+    } else {
+        dma_set_trigger(ch, bus->dma_tx_tsel);
+        DMA_REG16(ch, OFS_DMA0SA) = (uintptr_t) (bus->pkg->data + 1);
+        DMA_REG16(ch, OFS_DMA0DA) = bus->base + OFS_UCBxTXBUF;
+        DMA_REG16(ch, OFS_DMA0SZ) = len;
+        DMA_REG16(ch, OFS_DMA0CTL) = ctl | DMASRCINCR_3 | DMADSTINCR_0;
+    }
+    // only a NACK or the STOP need the ISR until the DMA is done
+    I2C_REG16(bus->base, OFS_UCBxIE) &= ~(UCTXIE | UCRXIE);
+}
+
+// true if the data phase of the current package goes through the DMA
+static inline uint8_t i2c_dma_use(struct i2c_bus *bus)
+{
+    return (bus->dma_ch != I2C_NO_DMA) && (bus->pkg->data_len >= I2C_DMA_MIN);
+}
+
+// runs in the DMA ISR once the channel has moved its block
+static uint8_t i2c_dma_handler(const uint8_t ch)
+{
+    struct i2c_bus *bus = NULL;
+    uint8_t i;
+
+    for (i = 0; i < I2C_BUS_CNT; i++) {
+        if (i2c_buses[i]->dma_ch == ch) {
+            bus = i2c_buses[i];
+        }
+    }
+    if (bus == NULL) {
+        return 0;
+    }
+
+    if (bus->next_state == SM_READ_DATA) {
+        // the byte in flight is the last one
+        bus->idx = bus->pkg->data_len - 1;
+        I2C_REG16(bus->base, OFS_UCBxCTLW0) |= UCTXSTP;
+        I2C_REG16(bus->base, OFS_UCBxIE) |= UCRXIE;
+    } else {
+        // all bytes are in, wait for the last one to leave TXBUF
+        bus->idx = bus->pkg->data_len;
+        bus->next_state = SM_DONE;
+        I2C_REG16(bus->base, OFS_UCBxIE) |= UCTXIE;
+    }
+    return 0;
+}
+#endif
 
-void i2c_irq_init(const uint16_t usci_base_addr)
+uint8_t i2c_irq_init(const uint16_t usci_base_addr)
 {
+    struct i2c_bus *bus = i2c_bus_get(usci_base_addr);
+
+    if (bus == NULL) {
+        return EXIT_FAILURE;
+    }
+
     // UCBxCTLW0 and UCBxBRW must be setup externally
-    I2C_CTL1 &= ~UCSWRST;       // Clear reset
-    //EUSCI_B_I2C_enable(usci_base_addr);
-    transfer.status = I2C_IDLE;
+    I2C_REG16(bus->base, OFS_UCBxCTLW0) &= ~UCSWRST;    // Clear reset
+    recq_init(&bus->q, bus->q_mem, sizeof(i2c_transfer_t *), I2C_QUEUE_SZ);
+#ifdef I2C_USES_DMA
+    if (bus->dma_ch != I2C_NO_DMA) {
+        DMA_REG16(bus->dma_ch, OFS_DMA0CTL) = 0;
+        dma_set_irq_handler(bus->dma_ch, i2c_dma_handler);
+    }
+#endif
+    bus->xfer = NULL;
+    bus->status = I2C_IDLE;
+
+    return EXIT_SUCCESS;
 }
 
-void i2c_transfer_start(const uint16_t base_addr, const i2c_package_t * pkg,
-                        void (*callback) (i2c_status_t result))
+// program the USCI for the first phase of a package
+// returns EXIT_FAILURE if the package holds nothing to transfer
+static uint8_t i2c_pkg_start(struct i2c_bus *bus, i2c_package_t * pkg)
 {
-    if (i2c_transfer_status() == I2C_BUSY) {
-        return;
+    uint16_t base = bus->base;
+    uint16_t cnt;
+    uint16_t ie = UCNACKIE | UCSTPIE;
+    uint8_t rx;
+
+    rx = (pkg->options & I2C_READ) && pkg->data_len;
+    if (!rx && !pkg->addr_len && !(pkg->data_len && (pkg->options & I2C_WRITE))) {
+        return EXIT_FAILURE;
+    }
+
+    bus->pkg = pkg;
+    bus->idx = 0;
+
+    // number of bytes in the phase that ends with the STOP
+    if (rx) {
+        cnt = pkg->data_len;
+    } else {
+        cnt = pkg->addr_len + pkg->data_len;
     }
 
-    transfer.pkg = (i2c_package_t *) pkg;
-    transfer.idx = 0;
-    transfer.callback = callback;
-    transfer.status = I2C_BUSY;
+    // UCBxTBCNT and UCASTPx can only be changed while the USCI is in reset
+    I2C_REG16(base, OFS_UCBxCTLW0) |= UCSWRST;
+    if (cnt > 255) {
+        // too long for the byte counter
+        bus->stop = STOP_MANUAL;
+        I2C_REG16(base, OFS_UCBxCTLW1) = I2C_CWR1 & ~UCASTP_3;
+    } else if (rx && (pkg->addr_len >= cnt)) {
+        // the register address would reach the threshold before the repeated START
+        bus->stop = STOP_CNTIFG;
+        I2C_REG16(base, OFS_UCBxTBCNT) = cnt;
+        I2C_REG16(base, OFS_UCBxCTLW1) = (I2C_CWR1 & ~UCASTP_3) | UCASTP_1;
+        ie |= UCBCNTIE;
+    } else {
+        // the byte counter is reset by the repeated START of a read
+        bus->stop = STOP_AUTO;
+        I2C_REG16(base, OFS_UCBxTBCNT) = cnt;
+        I2C_REG16(base, OFS_UCBxCTLW1) = (I2C_CWR1 & ~UCASTP_3) | UCASTP_2;
+    }
+    I2C_REG16(base, OFS_UCBxCTLW0) &= ~UCSWRST;
 
+    I2C_REG16(base, OFS_UCBxI2CSA) = pkg->slave_addr;
     if (pkg->addr_len != 0) {
         // if i2c also need to send an adress/command between the slave 
         // addr and the actual read/write of data
-        transfer.next_state = SM_SEND_ADDR;
-        I2C_IFG = 0;
-        I2C_IE = UCNACKIE | UCTXIE | UCRXIE;
-        I2C_SA = pkg->slave_addr;
-        I2C_CTL1 |= UCTR;           // set to transmitter mode
-        I2C_CTL1 |= UCTXSTT;        // start condition (send slave address)
-        __bis_SR_register(LPM0_bits + GIE);
-    }  else if (pkg->data_len != 0) {
-
-        if (pkg->options & I2C_READ) {
-            transfer.next_state = SM_SEND_RESTART;
-            I2C_IFG = 0;
-            I2C_IE = UCNACKIE | UCRXIE;
-            I2C_SA = pkg->slave_addr;
-            I2C_CTL1 &= ~UCTR;  // set to receiver mode
-
-            while (I2C_CTL1 & UCTXSTP) {}        // Ensure stop condition got sent
-            I2C_CTL1 |= UCTXSTT;        // start condition
-            if (transfer.pkg->data_len == 1) {
-                // wait for STT bit to drop
-                while (I2C_CTL1 & UCTXSTT) {}
-                I2C_CTL1 |= UCTXSTP;        // schedule stop condition
+        bus->next_state = SM_SEND_ADDR;
+        ie |= UCTXIE | UCRXIE;
+        I2C_REG16(base, OFS_UCBxCTLW0) |= UCTR;     // set to transmitter mode
+    } else if (rx) {
+        bus->next_state = SM_READ_DATA;
+        ie |= UCRXIE;
+        I2C_REG16(base, OFS_UCBxCTLW0) &= ~UCTR;    // set to receiver mode
+    } else {
+        bus->next_state = SM_WRITE_DATA;
+        ie |= UCTXIE | UCRXIE;
+        I2C_REG16(base, OFS_UCBxCTLW0) |= UCTR;     // set to transmitter mode
+    }
+    I2C_REG16(base, OFS_UCBxIFG) = 0;
+    I2C_REG16(base, OFS_UCBxIE) = ie;
+#ifdef I2C_USES_DMA
+    if ((bus->next_state == SM_READ_DATA) && i2c_dma_use(bus)) {
+        i2c_dma_start(bus, 1);
+    }
+#endif
+    I2C_REG16(base, OFS_UCBxCTLW0) |= UCTXSTT;      // start condition (send slave address)
+
+    return EXIT_SUCCESS;
+}
+
+// called once a package has ended, result is I2C_IDLE on success.
+// starts the next package of the current transaction or, once the transaction
+// is over, calls its callback and starts the next queued transaction.
+// must be called with interrupts disabled.
+static void i2c_xfer_advance(struct i2c_bus *bus, i2c_status_t result)
+{
+    i2c_transfer_t *t;
+    i2c_transfer_t **next;
+
+    for (;;) {
+        t = bus->xfer;
+        if (t) {
+            if (result == I2C_IDLE) {
+                while (bus->pkg_idx < t->pkg_cnt) {
+                    if (i2c_pkg_start(bus, &t->pkg[bus->pkg_idx++]) == EXIT_SUCCESS) {
+                        return;
+                    }
+                }
+            }
+            // the transaction is over
+            I2C_REG16(bus->base, OFS_UCBxIE) = 0;
+            bus->xfer = NULL;
+            recq_pop(&bus->q);
+            t->status = result;
+            // bus->status is still I2C_BUSY, so transactions queued by
+            // the callback are picked up by this loop
+            if (t->callback) {
+                t->callback(t);
             }
-            // update next state
-            transfer.next_state = SM_READ_DATA;
-            __bis_SR_register(LPM0_bits + GIE);
-        } else if (pkg->options & I2C_WRITE) {
-            transfer.next_state = SM_WRITE_DATA;
-            I2C_IFG = 0;
-            I2C_IE = UCNACKIE | UCTXIE | UCRXIE;
-            I2C_SA = pkg->slave_addr;
-            I2C_CTL1 |= UCTR;           // set to transmitter mode
-            I2C_CTL1 |= UCTXSTT;        // start condition (send slave address)
-            __bis_SR_register(LPM0_bits + GIE);
         }
-        
-    } else {
-        transfer.next_state = SM_DONE;
+
+        next = (i2c_transfer_t **) recq_peek(&bus->q);
+        if (next == NULL) {
+            bus->status = result;
+            return;
+        }
+        bus->xfer = *next;
+        bus->pkg_idx = 0;
+        bus->status = I2C_BUSY;
+        result = I2C_IDLE;
+    }
+}
+
+// add a transaction to the queue and kick off the bus if it was idle
+// must be called with interrupts disabled
+static uint8_t i2c_xfer_put(struct i2c_bus *bus, i2c_transfer_t * t)
+{
+    if (!recq_put(&bus->q, &t)) {
+        return EXIT_FAILURE;
+    }
+    t->status = I2C_BUSY;
+    if (bus->status != I2C_BUSY) {
+        bus->status = I2C_BUSY;
+        i2c_xfer_advance(bus, I2C_IDLE);
     }
+    return EXIT_SUCCESS;
+}
+
+uint8_t i2c_transfer_queue(const uint16_t base_addr, i2c_transfer_t * t)
+{
+    struct i2c_bus *bus = i2c_bus_get(base_addr);
+    uint16_t state;
+    uint8_t ret;
+
+    if (bus == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    ret = i2c_xfer_put(bus, t);
+    __set_interrupt_state(state);
+
+    return ret;
+}
+
+void i2c_transfer_wait(i2c_transfer_t * t)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    while (t->status == I2C_BUSY) {
+        // the ISR wakes us up after every package
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __set_interrupt_state(state);
+}
+
+i2c_status_t i2c_transfer_run(const uint16_t base_addr, i2c_transfer_t * t)
+{
+    struct i2c_bus *bus = i2c_bus_get(base_addr);
+    uint16_t state;
+
+    if (bus == NULL) {
+        t->status = I2C_FAILED;
+        return I2C_FAILED;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    while (i2c_xfer_put(bus, t) != EXIT_SUCCESS) {
+        // the queue is full, sleep until a slot is freed
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __set_interrupt_state(state);
+
+    i2c_transfer_wait(t);
+
+    return t->status;
+}
+
+i2c_status_t i2c_transfer_run_pkg(const uint16_t base_addr, i2c_package_t * pkg)
+{
+    i2c_transfer_t t;
+
+    t.pkg = pkg;
+    t.pkg_cnt = 1;
+    t.callback = NULL;
+
+    return i2c_transfer_run(base_addr, &t);
+}
+
+// transaction callback of i2c_transfer_start(), runs in the ISR
+static void i2c_start_done(i2c_transfer_t * t)
+{
+    uint8_t i;
+
+    for (i = 0; i < I2C_BUS_CNT; i++) {
+        if ((&i2c_buses[i]->start_xfer == t) && i2c_buses[i]->start_cb) {
+            i2c_buses[i]->start_cb(t->status);
+        }
+    }
+}
+
+void i2c_transfer_start(const uint16_t base_addr, const i2c_package_t * pkg,
+                        void (*callback) (i2c_status_t result))
+{
+    struct i2c_bus *bus = i2c_bus_get(base_addr);
+    uint16_t state;
+
+    if (bus == NULL) {
+        return;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    // like before the queue existed, a package handed over while the bus is busy is ignored
+    if (bus->status != I2C_BUSY) {
+        bus->start_xfer.pkg = (i2c_package_t *) pkg;
+        bus->start_xfer.pkg_cnt = 1;
+        bus->start_xfer.callback = i2c_start_done;
+        bus->start_cb = callback;
+        i2c_xfer_put(bus, &bus->start_xfer);
+    }
+    __set_interrupt_state(state);
 }
 
 i2c_status_t i2c_transfer_status(void)
 {
-    i2c_status_t status;
+    i2c_status_t ret = I2C_IDLE;
+    uint8_t i;
 
-    //ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-    status = transfer.status;
-    //}
+    for (i = 0; i < I2C_BUS_CNT; i++) {
+        if (i2c_buses[i]->status == I2C_BUSY) {
+            return I2C_BUSY;
+        } else if (i2c_buses[i]->status == I2C_FAILED) {
+            ret = I2C_FAILED;
+        }
+    }
 
-    return (status);
+    return ret;
 }
 
+i2c_status_t i2c_bus_status(const uint16_t base_addr)
+{
+    struct i2c_bus *bus = i2c_bus_get(base_addr);
+
+    if (bus == NULL) {
+        return I2C_FAILED;
+    }
+
+    return (bus->status);
+}
 
-__attribute__ ((interrupt(I2C_ISR_VECTOR)))
-void USCI_BX_ISR(void)
+// common interrupt handler. always inlined into the per-instance ISRs below
+// so that base is a constant and every register access is a direct one.
+// returns 1 if the main loop needs to wake up
+static inline __attribute__ ((always_inline))
+uint8_t i2c_isr(struct i2c_bus *bus, const uint16_t base)
 {
-    switch (HWREG16(EUSCI_BASE_ADDR + OFS_UCBxIV)) {
+    switch (I2C_REG16(base, OFS_UCBxIV)) {
 
     case USCI_NONE:
         break;
@@ -115,22 +545,35 @@ void USCI_BX_ISR(void)
         // Arbitration lost interrupt
         break;                  // Vector 2: ALIFG
     case USCI_I2C_UCNACKIFG:   // Vector 4: NACKIFG
-        I2C_IFG = 0;
-        I2C_IE = 0;
-        transfer.status = I2C_FAILED;
-        I2C_CTL1 |= UCTXSTP;    // set stop condition
-        if (transfer.callback) {
-            transfer.callback(I2C_FAILED);
+        I2C_REG16(base, OFS_UCBxIFG) = 0;
+        I2C_REG16(base, OFS_UCBxIE) = 0;
+#ifdef I2C_USES_DMA
+        if (bus->dma_ch != I2C_NO_DMA) {
+            DMA_REG16(bus->dma_ch, OFS_DMA0CTL) = 0;
         }
-        __bic_SR_register_on_exit(LPM0_bits);
-        return;
-        //break;
+#endif
+        I2C_REG16(base, OFS_UCBxCTLW0) |= UCTXSTP;  // set stop condition
+        // the rest of the transaction is skipped once the STOP is through
+        bus->next_state = SM_NACKED;
+        I2C_REG16(base, OFS_UCBxIE) = UCSTPIE;
+        return 0;
     case USCI_I2C_UCSTTIFG:
         // START condition detected interrupt, own address detected on the bus
         break;
     case USCI_I2C_UCSTPIFG:
-        // STOP condition detected interrupt
-        break;
+        // STOP condition detected interrupt, the package is over
+        I2C_REG16(base, OFS_UCBxIE) = 0;
+        if (bus->next_state == SM_NACKED) {
+            i2c_xfer_advance(bus, I2C_FAILED);
+            return 1;
+        }
+        if ((bus->next_state == SM_READ_DATA) && (I2C_REG16(base, OFS_UCBxIFG) & UCRXIFG)
+            && (bus->idx < bus->pkg->data_len)) {
+            // UCSTPIFG has priority, the last byte may still wait in RXBUF
+            bus->pkg->data[bus->idx++] = I2C_REG16(base, OFS_UCBxRXBUF);
+        }
+        i2c_xfer_advance(bus, I2C_IDLE);
+        return 1;
     case USCI_I2C_UCRXIFG3:
         // data RX
         break;
@@ -156,8 +599,13 @@ void USCI_BX_ISR(void)
         // data TX
         break;
     case USCI_I2C_UCBCNTIFG:
-        // byte counter interrupt
-        break;
+        // byte counter interrupt, only enabled for STOP_CNTIFG. the threshold is also
+        // reached while the register address goes out, but UCTXSTT stays set until
+        // the repeated START is through
+        if ((bus->next_state == SM_READ_DATA) && !(I2C_REG16(base, OFS_UCBxCTLW0) & UCTXSTT)) {
+            I2C_REG16(base, OFS_UCBxCTLW0) |= UCTXSTP;     // the byte on the wire is the last one
+        }
+        return 0;
     case USCI_I2C_UCCLTOIFG:
         // clock low time-out
         break;
@@ -168,75 +616,146 @@ void USCI_BX_ISR(void)
         break;
     }
 
-    I2C_IFG = 0;
-    
-    switch (transfer.next_state) {
+    // reading UCBxIV has cleared the flag being served. the other flags are left
+    // alone, a pending UCSTPIFG must not get lost
+
+    switch (bus->next_state) {
     case SM_SEND_ADDR:         // (TX optional register/command)
-        I2C_TXBUF = transfer.pkg->addr[transfer.idx];
-        transfer.idx++;
-        if (transfer.idx == transfer.pkg->addr_len) {
-            if (transfer.pkg->data_len != 0) {
-                transfer.idx = 0;
-                if (transfer.pkg->options & I2C_READ) {
-                    transfer.next_state = SM_SEND_RESTART;
+        I2C_REG16(base, OFS_UCBxTXBUF) = bus->pkg->addr[bus->idx];
+        bus->idx++;
+        if (bus->idx == bus->pkg->addr_len) {
+            if (bus->pkg->data_len != 0) {
+                bus->idx = 0;
+                if (bus->pkg->options & I2C_READ) {
+                    bus->next_state = SM_SEND_RESTART;
                 } else {
-                    transfer.next_state = SM_WRITE_DATA;
-                    I2C_CTL1 |= UCTR;   // set to transmitter mode
+                    bus->next_state = SM_WRITE_DATA;
+                    I2C_REG16(base, OFS_UCBxCTLW0) |= UCTR; // set to transmitter mode
                 }
             } else {
-                transfer.next_state = SM_DONE;
+                bus->next_state = SM_DONE;
             }
-        } // else { transfer.next_state remains SM_SEND_ADDR, so we end up in this case again }
+        } // else { bus->next_state remains SM_SEND_ADDR, so we end up in this case again }
         break;
     case SM_WRITE_DATA:
-        I2C_TXBUF = transfer.pkg->data[transfer.idx];
-        transfer.idx++;
-        if (transfer.idx == transfer.pkg->data_len) {
+        I2C_REG16(base, OFS_UCBxTXBUF) = bus->pkg->data[bus->idx];
+        bus->idx++;
+#ifdef I2C_USES_DMA
+        if ((bus->idx == 1) && i2c_dma_use(bus)) {
+            // the DMA loads the rest of the data
+            i2c_dma_start(bus, 0);
+            break;
+        }
+#endif
+        if (bus->idx == bus->pkg->data_len) {
             // that was the last data byte to send.
             // update next state
-            transfer.next_state = SM_DONE;
+            bus->next_state = SM_DONE;
         }
         break;
     case SM_SEND_RESTART:
-        I2C_CTL1 &= ~UCTR;      // Set to receiver mode
-        I2C_CTL1 |= UCTXSTT;    // write (re)start condition
-
-        if (transfer.pkg->data_len == 1) {
-            // wait for STT bit to drop
-            while (I2C_CTL1 & UCTXSTT) {};
-            I2C_CTL1 |= UCTXSTP;        // schedule stop condition
+        I2C_REG16(base, OFS_UCBxCTLW0) &= ~UCTR;    // Set to receiver mode
+#ifdef I2C_USES_DMA
+        if (i2c_dma_use(bus)) {
+            bus->next_state = SM_READ_DATA;
+            i2c_dma_start(bus, 1);
         }
+#endif
+        I2C_REG16(base, OFS_UCBxCTLW0) |= UCTXSTT;  // write (re)start condition
         // update next state
-        transfer.next_state = SM_READ_DATA;
+        bus->next_state = SM_READ_DATA;
         break;
     case SM_READ_DATA:
-        transfer.pkg->data[transfer.idx] = I2C_RXBUF;
-        transfer.idx++;
-        if (transfer.idx == transfer.pkg->data_len - 1) {
-            // next incoming byte is the last one.
-            I2C_CTL1 |= UCTXSTP;        // schedule stop condition
-            break;
-        } else if (transfer.idx < transfer.pkg->data_len) {
+        bus->pkg->data[bus->idx] = I2C_REG16(base, OFS_UCBxRXBUF);
+        bus->idx++;
+        if (bus->idx < bus->pkg->data_len) {
             // still more to recv.
+            if ((bus->stop == STOP_MANUAL) && (bus->idx == bus->pkg->data_len - 1)) {
+                // next incoming byte is the last one.
+                I2C_REG16(base, OFS_UCBxCTLW0) |= UCTXSTP;  // schedule stop condition
+            }
             break;
         }
         // otherwise, that was the last data byte to recv.
         // fall through
     case SM_DONE:
-        I2C_IE = 0;
-        //if (transfer.pkg->read == false) {
-        if (transfer.pkg->options & I2C_WRITE) {
+        if ((bus->stop == STOP_MANUAL) && (I2C_REG16(base, OFS_UCBxCTLW0) & UCTR)) {
             // If finished a write, schedule a stop condition
-            I2C_CTL1 |= UCTXSTP;
+            I2C_REG16(base, OFS_UCBxCTLW0) |= UCTXSTP;
         }
-        transfer.status = I2C_IDLE;
-        if (transfer.callback) {
-            transfer.callback(I2C_IDLE);
-        }
-        __bic_SR_register_on_exit(LPM0_bits);
+        // the package ends with UCSTPIFG
+        I2C_REG16(base, OFS_UCBxIE) &= ~(UCTXIE | UCRXIE);
         break;
+    case SM_NACKED:
+        break;
+    }
+
+    return 0;
+}
+
+#ifdef I2C_USES_UCB0
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_B0_VECTOR
+__interrupt void USCI_B0_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_B0_VECTOR))) USCI_B0_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (i2c_isr(&i2c_b0, EUSCI_B0_BASE)) {
+        __bic_SR_register_on_exit(LPM0_bits);
+    }
+}
+#endif
+
+#ifdef I2C_USES_UCB1
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_B1_VECTOR
+__interrupt void USCI_B1_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_B1_VECTOR))) USCI_B1_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (i2c_isr(&i2c_b1, EUSCI_B1_BASE)) {
+        __bic_SR_register_on_exit(LPM0_bits);
     }
 }
+#endif
+
+#ifdef I2C_USES_UCB2
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_B2_VECTOR
+__interrupt void USCI_B2_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_B2_VECTOR))) USCI_B2_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (i2c_isr(&i2c_b2, EUSCI_B2_BASE)) {
+        __bic_SR_register_on_exit(LPM0_bits);
+    }
+}
+#endif
+
+#ifdef I2C_USES_UCB3
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_B3_VECTOR
+__interrupt void USCI_B3_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_B3_VECTOR))) USCI_B3_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (i2c_isr(&i2c_b3, EUSCI_B3_BASE)) {
+        __bic_SR_register_on_exit(LPM0_bits);
+    }
+}
+#endif
 
 #else
 //////////////////////////////////////////////////
@@ -311,6 +830,28 @@ void i2c_transfer_start(const uint16_t base_addr, const i2c_package_t * pkg,
         EUSCI_B_I2C_masterSendMultiByteStop(base_addr);
     }
 }
+
+i2c_status_t i2c_transfer_run(const uint16_t base_addr, i2c_transfer_t * t)
+{
+    uint8_t i;
+
+    for (i = 0; i < t->pkg_cnt; i++) {
+        i2c_transfer_start(base_addr, &t->pkg[i], NULL);
+    }
+
+    t->status = I2C_IDLE;
+    if (t->callback) {
+        t->callback(t);
+    }
+
+    return I2C_IDLE;
+}
+
+i2c_status_t i2c_transfer_run_pkg(const uint16_t base_addr, i2c_package_t * pkg)
+{
+    i2c_transfer_start(base_addr, pkg, NULL);
+    return I2C_IDLE;
+}
 #endif
 
 ///\}
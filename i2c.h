@@ -78,31 +78,103 @@ extern "C" {
         I2C_FAILED              ///< previous transfer failed. ready for new transfer.
     } i2c_status_t;
 
+    /// a transaction made of one or more packages that are executed back to back
+    typedef struct i2c_transfer {
+        i2c_package_t *pkg;     ///< array of packages
+        uint8_t pkg_cnt;        ///< number of packages
+        /// optional, called once all packages are done or one of them failed.
+        /// in the IRQ_I2C build it runs in interrupt context and may queue new transactions.
+        void (*callback) (struct i2c_transfer * t);
+        volatile i2c_status_t status;   ///< I2C_BUSY while queued or in progress, I2C_IDLE or I2C_FAILED once over
+    } i2c_transfer_t;
+
 /**
  * \brief Start an I2C transfer
  * 
- * This function begins a new I2C transaction as described by the \c pkg struct. This function
- * is nonblocking and returns immediately after the transfer is started. The status of the transfer 
- * can be polled using the i2c_transfer_status() function. Alternatively, a \c callback function can
- * be executed when the transfer completes.
+ * This function begins a new I2C transaction as described by the \c pkg struct. In the IRQ_I2C
+ * build it is nonblocking and returns immediately after the transfer is started, \c pkg must stay
+ * valid until it is over. The status of the transfer can be polled using the i2c_transfer_status()
+ * function. Alternatively, a \c callback function can be executed when the transfer completes.
+ * The package is ignored if the bus is busy. Use i2c_transfer_run_pkg() to wait for the result.
  * 
  * \note Global interrupts must be enabled.
  * 
  * \param base_address  MSP430-related register address of the USCI subsystem. can be USCI_B0_BASE - USCI_B1_BASE, EUSCI_B0_BASE - EUSCI_B3_BASE
  * \param pkg           Pointer to a package struct that describes the transfer operation.
  * \param callback      Optional pointer to a callback function to execute once the transfer completes
- *                      or fails. A NULL pointer disables the callback.
+ *                      or fails. A NULL pointer disables the callback. In the IRQ_I2C build it runs
+ *                      in interrupt context.
  **/
     void i2c_transfer_start(const uint16_t base_address, const i2c_package_t * pkg,
                             void (*callback) (i2c_status_t result));
 
 /**
- * \brief Get the status of the I2C module
- * \return status of the bus.
+ * \brief Execute a single package and wait for it to finish
+ *
+ * Blocking counterpart of i2c_transfer_start(), see i2c_transfer_run().
+ *
+ * \return I2C_IDLE on success, I2C_FAILED if the package was NACKed
+ **/
+    i2c_status_t i2c_transfer_run_pkg(const uint16_t base_address, i2c_package_t * pkg);
+
+/**
+ * \brief Execute a transaction and wait for it to finish
+ *
+ * In the IRQ_I2C build the transaction is queued (waiting in LPM0 for a free slot if the
+ * queue is full) and the CPU sleeps in LPM0 until it is over. The blocking build simply runs
+ * the packages one after the other.
+ *
+ * \param base_address  MSP430-related register address of the USCI subsystem
+ * \param t             transaction, the packages are sent in order and each ends with a STOP
+ * \note Not to be called from a transaction callback, use i2c_transfer_queue() there.
+ *
+ * \return I2C_IDLE on success, I2C_FAILED if a package was NACKed
+ **/
+    i2c_status_t i2c_transfer_run(const uint16_t base_address, i2c_transfer_t * t);
+
+/**
+ * \brief Queue a transaction without waiting for it (IRQ_I2C only)
+ *
+ * The ISR starts the transaction as soon as the ones queued before it are over, walks through
+ * its packages and calls t->callback at the end. \c t and its packages must stay valid until
+ * t->status is no longer I2C_BUSY. Up to I2C_QUEUE_SZ - 1 transactions can be pending.
+ *
+ * \param base_address  MSP430-related register address of the USCI subsystem
+ * \param t             transaction
+ * \return EXIT_SUCCESS, or EXIT_FAILURE if the queue is full
+ **/
+    uint8_t i2c_transfer_queue(const uint16_t base_address, i2c_transfer_t * t);
+
+/**
+ * \brief Sleep in LPM0 until a queued transaction is over (IRQ_I2C only)
+ **/
+    void i2c_transfer_wait(i2c_transfer_t * t);
+
+/**
+ * \brief Get the status of the I2C module (IRQ_I2C only)
+ * \return status of the bus. with several instances enabled I2C_BUSY if any of them is busy,
+ *         otherwise I2C_FAILED if the last transaction of any of them failed
  **/
     i2c_status_t i2c_transfer_status(void);
 
-    void i2c_irq_init(uint16_t usci_base_address);
+/**
+ * \brief Get the status of a single I2C bus (IRQ_I2C only)
+ * \param base_address  MSP430-related register address of the USCI subsystem
+ * \return status of the bus, I2C_FAILED if the instance is not enabled in i2c_config.h
+ **/
+    i2c_status_t i2c_bus_status(const uint16_t base_address);
+
+/**
+ * \brief Prepare the queue and state of an eUSCI_B instance (IRQ_I2C only)
+ *
+ * Each instance enabled with I2C_USES_UCBx in i2c_config.h has its own transaction queue and ISR,
+ * so transactions on different buses run concurrently. UCBxCTLW0 and UCBxBRW must be set up
+ * beforehand.
+ *
+ * \param usci_base_address  EUSCI_B0_BASE - EUSCI_B3_BASE
+ * \return EXIT_SUCCESS, or EXIT_FAILURE if the instance is not enabled in i2c_config.h
+ **/
+    uint8_t i2c_irq_init(const uint16_t usci_base_address);
 
 #ifdef __cplusplus
 }
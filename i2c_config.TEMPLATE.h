@@ -22,17 +22,13 @@
 //  = NOTE: Actual ports must be configured manually! =
 //  ===================================================
 
-/// Select which USCI module to use
-#define I2C_USE_DEV        2    ///< \hideinitializer
-/**<    0 = USCIB0 \n
-*         1 = USCIB1 \n
-*         2 = USCIB2 \n
-*         3 = USCIB3 \n
-*         4 = EUSCIB0 \n
-*         5 = EUSCIB1 \n
-*         6 = EUSCIB2 \n
-*         7 = EUSCIB3 \n
-**/
+/// Select the eUSCI_B instances served by the IRQ_I2C build, each gets its own
+/// transaction queue and ISR. older configurations may still use I2C_USE_DEV 4..7
+/// to select a single instance
+//#define I2C_USES_UCB0
+//#define I2C_USES_UCB1
+#define I2C_USES_UCB2
+//#define I2C_USES_UCB3
 
 /// Select which clock source to use
 #define I2C_CLK_SRC     2    ///< \hideinitializer
@@ -47,6 +43,21 @@
 /// optional eUSCI Control Word Register 1
 #define I2C_CWR1        0   ///< \hideinitializer
 
+/// number of slots in the transaction queue of the IRQ_I2C build, must be a power of two.
+/// one slot is kept free.
+#define I2C_QUEUE_SZ    8   ///< \hideinitializer
+
+/// optional, let a DMA channel move the data phase of large packages in the IRQ_I2C build.
+/// needs CONFIG_DMA. every instance that should use it needs a channel of its own
+//#define I2C_USES_DMA
+//#define I2C_UCB2_DMA_CH  2
+/// packages with at least this many data bytes use the DMA
+#define I2C_DMA_MIN     16  ///< \hideinitializer
+/// DMA trigger numbers of UCBxRXIFG0 and UCBxTXIFG0, see 'DMA Trigger Assignments' in the
+/// device datasheet. they depend on both the USCI and the DMA channel. only UCB0 has defaults
+//#define I2C_UCB0_DMA_RX_TSEL 18  // UCB0RXIFG0
+//#define I2C_UCB0_DMA_TX_TSEL 19  // UCB0TXIFG0
+
 ///\}
 
 #endif
@@ -30,7 +30,7 @@
 
 /**
 * \file
-* \brief Internal include for \ref MOD_I2C. Abstracts register names between MSP430 devices
+* \brief Internal include for \ref MOD_I2C. Selects the eUSCI_B instances used by the IRQ driver
 * \author Alex Mykyta
 **/
 
@@ -49,162 +49,38 @@
 #error "Invalid I2C_CLK_DIV in i2c_config.h"
 #endif
 
-#if I2C_USE_DEV == 0
-#if defined(__MSP430_HAS_USCI_B0__)
-#define I2C_CTL0        UCB0CTL0
-#define I2C_CTL1        UCB0CTL1
-#define I2C_BR          UCB0BRW
-#define I2C_STAT        UCB0STAT
-#define I2C_RXBUF       UCB0RXBUF
-#define I2C_TXBUF       UCB0TXBUF
-#define I2C_OA          UCB0I2COA
-#define I2C_SA          UCB0I2CSA
-#define I2C_ICTL        UCB0ICTL
-#define I2C_IE          UCB0IE
-#define I2C_IFG         UCB0IFG
-#define I2C_IV          UCB0IV
-#define I2C_ISR_VECTOR  USCI_B0_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
-#endif
-
-#elif I2C_USE_DEV == 1
-#if defined(__MSP430_HAS_USCI_B1__)
-#define I2C_CTL0        UCB1CTL0
-#define I2C_CTL1        UCB1CTL1
-#define I2C_BR          UCB1BRW
-#define I2C_STAT        UCB1STAT
-#define I2C_RXBUF       UCB1RXBUF
-#define I2C_TXBUF       UCB1TXBUF
-#define I2C_OA          UCB1I2COA
-#define I2C_SA          UCB1I2CSA
-#define I2C_ICTL        UCB1ICTL
-#define I2C_IE          UCB1IE
-#define I2C_IFG         UCB1IFG
-#define I2C_IV          UCB1IV
-#define I2C_ISR_VECTOR  USCI_B1_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
-#endif
-
-#elif I2C_USE_DEV == 2
-#if defined(__MSP430_HAS_USCI_B2__)
-#define I2C_CTL0        UCB2CTL0
-#define I2C_CTL1        UCB2CTL1
-#define I2C_BR          UCB2BRW
-#define I2C_STAT        UCB2STAT
-#define I2C_RXBUF       UCB2RXBUF
-#define I2C_TXBUF       UCB2TXBUF
-#define I2C_OA          UCB2I2COA
-#define I2C_SA          UCB2I2CSA
-#define I2C_ICTL        UCB2ICTL
-#define I2C_IE          UCB2IE
-#define I2C_IFG         UCB2IFG
-#define I2C_IV          UCB2IV
-#define I2C_ISR_VECTOR  USCI_B2_VECTOR
+// the IRQ_I2C driver serves every eUSCI_B instance selected with I2C_USES_UCB0 ..
+// I2C_USES_UCB3. configurations that still pick a single instance through
+// I2C_USE_DEV get the matching flag
+#if !defined(I2C_USES_UCB0) && !defined(I2C_USES_UCB1) && !defined(I2C_USES_UCB2) && !defined(I2C_USES_UCB3)
+#if I2C_USE_DEV == 4
+#define I2C_USES_UCB0
+#elif I2C_USE_DEV == 5
+#define I2C_USES_UCB1
+#elif I2C_USE_DEV == 6
+#define I2C_USES_UCB2
+#elif I2C_USE_DEV == 7
+#define I2C_USES_UCB3
 #else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
+#error "select the eUSCI_B instances with I2C_USES_UCB0 .. I2C_USES_UCB3 in i2c_config.h"
 #endif
-
-#elif I2C_USE_DEV == 3
-#if defined(__MSP430_HAS_USCI_B3__)
-#define I2C_CTL0        UCB3CTL0
-#define I2C_CTL1        UCB3CTL1
-#define I2C_BR          UCB3BRW
-#define I2C_STAT        UCB3STAT
-#define I2C_RXBUF       UCB3RXBUF
-#define I2C_TXBUF       UCB3TXBUF
-#define I2C_OA          UCB3I2COA
-#define I2C_SA          UCB3I2CSA
-#define I2C_ICTL        UCB3ICTL
-#define I2C_IE          UCB3IE
-#define I2C_IFG         UCB3IFG
-#define I2C_IV          UCB3IV
-#define I2C_ISR_VECTOR  USCI_B3_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
 #endif
 
-#elif I2C_USE_DEV == 4
-#if defined(__MSP430_HAS_EUSCI_B0__)
-#define I2C_CTL0        UCB0CTLW0
-#define I2C_CTL1        UCB0CTLW0
-#define I2C_CTLW1       UCB0CTLW1
-#define I2C_BR          UCB0BRW
-#define I2C_STAT        UCB0STATW
-#define I2C_RXBUF       UCB0RXBUF
-#define I2C_TXBUF       UCB0TXBUF
-#define I2C_OA          UCB0I2COA0
-#define I2C_SA          UCB0I2CSA
-#define I2C_IE          UCB0IE
-#define I2C_IFG         UCB0IFG
-#define I2C_IV          UCB0IV
-#define I2C_ISR_VECTOR  EUSCI_B0_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
+#if defined(I2C_USES_UCB0) && !defined(__MSP430_HAS_EUSCI_B0__)
+#error "I2C_USES_UCB0 set in i2c_config.h but the device has no eUSCI_B0"
 #endif
-
-
-#elif I2C_USE_DEV == 5
-#if defined(__MSP430_HAS_EUSCI_B1__)
-#define I2C_CTL0        UCB1CTLW0
-#define I2C_CTL1        UCB1CTLW0
-#define I2C_CTLW1       UCB1CTLW1
-#define I2C_BR          UCB1BRW
-#define I2C_STAT        UCB1STATW
-#define I2C_RXBUF       UCB1RXBUF
-#define I2C_TXBUF       UCB1TXBUF
-#define I2C_OA          UCB1I2COA0
-#define I2C_SA          UCB1I2CSA
-#define I2C_IE          UCB1IE
-#define I2C_IFG         UCB1IFG
-#define I2C_IV          UCB1IV
-#define I2C_ISR_VECTOR  EUSCI_B1_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
+#if defined(I2C_USES_UCB1) && !defined(__MSP430_HAS_EUSCI_B1__)
+#error "I2C_USES_UCB1 set in i2c_config.h but the device has no eUSCI_B1"
 #endif
-
-#elif I2C_USE_DEV == 6
-#if defined(__MSP430_HAS_EUSCI_B2__)
-#define I2C_CTL0        UCB2CTLW0
-#define I2C_CTL1        UCB2CTLW0
-#define I2C_CTLW1       UCB2CTLW1
-#define I2C_BR          UCB2BRW
-#define I2C_STAT        UCB2STATW
-#define I2C_RXBUF       UCB2RXBUF
-#define I2C_TXBUF       UCB2TXBUF
-#define I2C_OA          UCB2I2COA0
-#define I2C_SA          UCB2I2CSA
-#define I2C_IE          UCB2IE
-#define I2C_IFG         UCB2IFG
-#define I2C_IV          UCB2IV
-#define I2C_ISR_VECTOR  EUSCI_B2_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
+#if defined(I2C_USES_UCB2) && !defined(__MSP430_HAS_EUSCI_B2__)
+#error "I2C_USES_UCB2 set in i2c_config.h but the device has no eUSCI_B2"
 #endif
-
-#elif I2C_USE_DEV == 7
-#if defined(__MSP430_HAS_EUSCI_B3__)
-#define I2C_CTL0        UCB3CTLW0
-#define I2C_CTL1        UCB3CTLW0
-#define I2C_CTLW1       UCB3CTLW1
-#define I2C_BR          UCB3BRW
-#define I2C_STAT        UCB3STATW
-#define I2C_RXBUF       UCB3RXBUF
-#define I2C_TXBUF       UCB3TXBUF
-#define I2C_OA          UCB3I2COA0
-#define I2C_SA          UCB3I2CSA
-#define I2C_IE          UCB3IE
-#define I2C_IFG         UCB3IFG
-#define I2C_IV          UCB3IV
-#define I2C_ISR_VECTOR  EUSCI_B3_VECTOR
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
+#if defined(I2C_USES_UCB3) && !defined(__MSP430_HAS_EUSCI_B3__)
+#error "I2C_USES_UCB3 set in i2c_config.h but the device has no eUSCI_B3"
 #endif
 
-#else
-#error "Invalid I2C_USE_DEV in i2c_config.h"
-#endif
+/// register access relative to the EUSCI_Bx_BASE of an instance
+#define I2C_REG16(base, ofs)  HWREG16((base) + (ofs))
 
 #endif
 
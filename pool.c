@@ -0,0 +1,62 @@
+// fixed-block pool allocator
+//
+// license:     BSD
+
+#include <msp430.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include "pool.h"
+
+void pool_init(struct pool *p, void *mem, const uint16_t sz, const uint16_t count)
+{
+    uint8_t *blk = (uint8_t *) mem;
+    uint16_t c;
+
+    p->bsize = POOL_BLOCK_SZ(sz);
+    p->free = NULL;
+
+    // chain the blocks so that the first one is handed out first
+    for (c = count; c > 0; c--) {
+        *(void **)(blk + (c - 1) * p->bsize) = p->free;
+        p->free = blk + (c - 1) * p->bsize;
+    }
+    p->nfree = count;
+}
+
+void *pool_alloc(struct pool *p)
+{
+    void *blk;
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    blk = p->free;
+    if (blk != NULL) {
+        p->free = *(void **)blk;
+        p->nfree--;
+    }
+    __set_interrupt_state(state);
+
+    return blk;
+}
+
+void pool_free(struct pool *p, void *blk)
+{
+    uint16_t state;
+
+    if (blk == NULL) {
+        return;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    *(void **)blk = p->free;
+    p->free = blk;
+    p->nfree++;
+    __set_interrupt_state(state);
+}
+
+uint16_t pool_available(struct pool *p)
+{
+    return p->nfree;
+}
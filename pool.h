@@ -0,0 +1,72 @@
+// fixed-block pool allocator
+//
+// hands out blocks of a single size from a statically allocated array. free blocks
+// are kept in an intrusive singly linked list (the first word of a free block points
+// to the next one), so both pool_alloc() and pool_free() are O(1), deterministic and
+// cause no fragmentation. the list is changed with interrupts disabled, so blocks can
+// be allocated and released both from ISRs and from the main loop.
+//
+// license:     BSD
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+/*!
+	\brief size of a pool block, rounded up so that every block is pointer-aligned
+*/
+#define POOL_BLOCK_SZ(sz) ((((sz) + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *))
+
+/*!
+	\brief define a pointer-aligned array that can hold count blocks of sz bytes
+    \details ex. POOL_MEM(frame_mem, sizeof(struct frame), 4);
+*/
+#define POOL_MEM(name, sz, count) void *name[(POOL_BLOCK_SZ(sz) / sizeof(void *)) * (count)]
+
+/*!
+	\brief state of a pool
+*/
+struct pool {
+    /*! head of the list of free blocks */
+    void *free;
+    /*! size of one block in bytes */
+    uint16_t bsize;
+    /*! number of free blocks */
+    uint16_t nfree;
+};
+
+/*!
+	\brief initialize a pool
+	\param p      pool state
+	\param mem    array that holds the blocks, see POOL_MEM()
+	\param sz     size of one block in bytes, it is rounded up via POOL_BLOCK_SZ()
+	\param count  number of blocks in mem
+*/
+void pool_init(struct pool *p, void *mem, const uint16_t sz, const uint16_t count);
+
+/*!
+	\brief take one block out of the pool
+	\return pointer to the block or NULL if the pool is exhausted
+*/
+void *pool_alloc(struct pool *p);
+
+/*!
+	\brief return a block obtained via pool_alloc()
+*/
+void pool_free(struct pool *p, void *blk);
+
+/*!
+	\brief number of blocks that can still be allocated
+*/
+uint16_t pool_available(struct pool *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+// ring queue of fixed-size records
+//
+// the same lock-free single producer/single consumer scheme as ringbuf.c:
+// the producer only writes put_ptr, the consumer only writes get_ptr and
+// the record is copied before the index that exposes it is updated.
+//
+// license:     BSD
+
+#include <inttypes.h>
+#include <string.h>
+#include "cc.h"
+#include "recqueue.h"
+
+void recq_init(struct recq *q, void *a, const uint16_t esize, const uint16_t count)
+{
+    q->data = (uint8_t *) a;
+    q->esize = esize;
+    q->mask = count - 1;
+    q->put_ptr = 0;
+    q->get_ptr = 0;
+}
+
+void *recq_alloc(struct recq *q)
+{
+    if (((q->put_ptr - CC_ACCESS_NOW(uint16_t, q->get_ptr)) & q->mask) == q->mask) {
+        return NULL;
+    }
+
+    return q->data + q->put_ptr * q->esize;
+}
+
+void recq_push(struct recq *q)
+{
+    CC_BARRIER();
+    CC_ACCESS_NOW(uint16_t, q->put_ptr) = (q->put_ptr + 1) & q->mask;
+}
+
+void *recq_peek(struct recq *q)
+{
+    if (((CC_ACCESS_NOW(uint16_t, q->put_ptr) - q->get_ptr) & q->mask) == 0) {
+        return NULL;
+    }
+
+    return q->data + q->get_ptr * q->esize;
+}
+
+void recq_pop(struct recq *q)
+{
+    CC_BARRIER();
+    CC_ACCESS_NOW(uint16_t, q->get_ptr) = (q->get_ptr + 1) & q->mask;
+}
+
+uint8_t recq_put(struct recq *q, const void *rec)
+{
+    void *slot = recq_alloc(q);
+
+    if (slot == NULL) {
+        return 0;
+    }
+    memcpy(slot, rec, q->esize);
+    recq_push(q);
+    return 1;
+}
+
+uint8_t recq_get(struct recq *q, void *rec)
+{
+    void *slot = recq_peek(q);
+
+    if (slot == NULL) {
+        return 0;
+    }
+    memcpy(rec, slot, q->esize);
+    recq_pop(q);
+    return 1;
+}
+
+uint16_t recq_get_n(struct recq *q, void *dst, const uint16_t count)
+{
+    uint16_t get_ptr = q->get_ptr;
+    uint16_t avail, n;
+
+    avail = (CC_ACCESS_NOW(uint16_t, q->put_ptr) - get_ptr) & q->mask;
+    avail = MIN(avail, count);
+
+    // copy the records in at most two chunks, before and after the wrap
+    n = MIN(avail, q->mask + 1 - get_ptr);
+    memcpy(dst, q->data + get_ptr * q->esize, n * q->esize);
+    if (avail > n) {
+        memcpy((uint8_t *) dst + n * q->esize, q->data, (avail - n) * q->esize);
+    }
+
+    CC_BARRIER();
+    CC_ACCESS_NOW(uint16_t, q->get_ptr) = (get_ptr + avail) & q->mask;
+    return avail;
+}
+
+uint16_t recq_elements(struct recq *q)
+{
+    return (q->put_ptr - q->get_ptr) & q->mask;
+}
+
+uint16_t recq_size(struct recq *q)
+{
+    return q->mask + 1;
+}
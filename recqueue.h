@@ -0,0 +1,102 @@
+// ring queue of fixed-size records
+//
+// a companion to ringbuf that stores whole records (structs, multi-byte samples)
+// instead of single bytes. one producer and one consumer can use the queue
+// without locking, typically an ISR filling it and the main loop draining it.
+// the number of records must be a power of two, so wrapping is done with a mask.
+//
+// license:     BSD
+
+#ifndef __RECQUEUE_H__
+#define __RECQUEUE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+/*!
+	\brief state of a record queue
+	\details the backing array (count * esize bytes) needs to be defined separately
+*/
+struct recq {
+    /*! backing array */
+    uint8_t *data;
+    /*! size of one record in bytes */
+    uint16_t esize;
+    /*! number of records - 1 */
+    uint16_t mask;
+    /*! record indices, 16-bit quantities to be accessed atomically */
+    uint16_t put_ptr, get_ptr;
+};
+
+/*!
+	\brief initialize a record queue
+	\param q        queue state
+	\param a        backing array, at least count * esize bytes long
+	\param esize    size of one record in bytes, usually sizeof(struct something)
+	\param count    number of records, must be a power of two. one slot is kept free
+	\sa recq_put, recq_get
+*/
+void recq_init(struct recq *q, void *a, const uint16_t esize, const uint16_t count);
+
+/*!
+	\brief copy a record into the queue
+	\return non-zero if the record was added, zero if the queue was full
+*/
+uint8_t recq_put(struct recq *q, const void *rec);
+
+/*!
+	\brief copy the oldest record out of the queue
+	\return non-zero if a record was retrieved, zero if the queue was empty
+*/
+uint8_t recq_get(struct recq *q, void *rec);
+
+/*!
+	\brief get a pointer to the next free slot
+	\details lets the producer build the record in place. it becomes visible to the
+	         consumer only after recq_push() is called
+	\return pointer to the slot or NULL if the queue is full
+	\sa recq_push
+*/
+void *recq_alloc(struct recq *q);
+
+/*!
+	\brief publish the slot obtained via recq_alloc()
+*/
+void recq_push(struct recq *q);
+
+/*!
+	\brief get a pointer to the oldest record without removing it
+	\return pointer to the record or NULL if the queue is empty
+	\sa recq_pop
+*/
+void *recq_peek(struct recq *q);
+
+/*!
+	\brief remove the oldest record, usually after recq_peek()
+*/
+void recq_pop(struct recq *q);
+
+/*!
+	\brief copy up to count records out of the queue
+	\return the number of records copied
+*/
+uint16_t recq_get_n(struct recq *q, void *dst, const uint16_t count);
+
+/*!
+	\brief number of records currently in the queue
+*/
+uint16_t recq_elements(struct recq *q);
+
+/*!
+	\brief number of slots in the queue
+*/
+uint16_t recq_size(struct recq *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,8 +38,34 @@
  */
 
 #include <inttypes.h>
+#include <string.h>
 #include "cc.h"
 #include "ringbuf.h"
+
+#ifdef CONFIG_RINGBUF_STATS
+#define RINGBUF_STATS_RETRIES 4
+
+static void ringbuf_account(struct ringbuf *r, const uint16_t written,
+                            const uint16_t dropped, const uint8_t overwritten)
+{
+    uint8_t elements;
+
+    CC_ACCESS_NOW(uint8_t, r->stats_seq) = r->stats_seq + 1;
+    CC_BARRIER();
+    r->stats.puts += written;
+    r->stats.drops += dropped;
+    r->stats.overwrites += overwritten;
+    elements = (r->put_ptr - CC_ACCESS_NOW(uint8_t, r->get_ptr)) & r->mask;
+    if (elements > r->stats.hwm) {
+        r->stats.hwm = elements;
+    }
+    CC_BARRIER();
+    CC_ACCESS_NOW(uint8_t, r->stats_seq) = r->stats_seq + 1;
+}
+#else
+#define ringbuf_account(r, written, dropped, overwritten) (void) (overwritten)
+#endif
+
 /*---------------------------------------------------------------------------*/
 void ringbuf_init(struct ringbuf *r, uint8_t * dataptr, uint16_t size)
 {
@@ -47,6 +73,17 @@ void ringbuf_init(struct ringbuf *r, uint8_t * dataptr, uint16_t size)
     r->mask = size - 1;
     r->put_ptr = 0;
     r->get_ptr = 0;
+    r->flags = 0;
+#ifdef CONFIG_RINGBUF_STATS
+    r->stats_seq = 0;
+    memset(&r->stats, 0, sizeof(struct ringbuf_stats));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+void ringbuf_set_policy(struct ringbuf *r, const uint8_t flags)
+{
+    r->flags = flags;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -61,8 +98,16 @@ uint8_t ringbuf_put(struct ringbuf *r, uint8_t c)
        be atomic. We use an uint8_t type, which makes access atomic on
        most platforms, but C does not guarantee this.
      */
+    uint8_t overwritten = 0;
+
     if (((r->put_ptr - r->get_ptr) & r->mask) == r->mask) {
-        return 0;
+        if (!(r->flags & RINGBUF_OVERWRITE)) {
+            ringbuf_account(r, 0, 1, 0);
+            return 0;
+        }
+        /* drop the oldest byte to make room */
+        CC_ACCESS_NOW(uint8_t, r->get_ptr) = (r->get_ptr + 1) & r->mask;
+        overwritten = 1;
     }
     /*
      * CC_ACCESS_NOW is used because the compiler is allowed to reorder
@@ -73,6 +118,7 @@ uint8_t ringbuf_put(struct ringbuf *r, uint8_t c)
      */
     CC_ACCESS_NOW(uint8_t, r->data[r->put_ptr]) = c;
     CC_ACCESS_NOW(uint8_t, r->put_ptr) = (r->put_ptr + 1) & r->mask;
+    ringbuf_account(r, 1, 0, overwritten);
     return 1;
 }
 
@@ -108,9 +154,9 @@ uint8_t ringbuf_get(struct ringbuf *r, uint8_t *c)
 }
 
 /*---------------------------------------------------------------------------*/
-uint8_t ringbuf_size(struct ringbuf *r)
+uint16_t ringbuf_size(struct ringbuf *r)
 {
-    return r->mask + 1;
+    return (uint16_t) r->mask + 1;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -120,3 +166,175 @@ uint8_t ringbuf_elements(struct ringbuf *r)
 }
 
 /*---------------------------------------------------------------------------*/
+uint16_t ringbuf_write_span(struct ringbuf *r, uint8_t **ptr)
+{
+    uint8_t put_ptr = r->put_ptr;
+    uint8_t space;
+    uint16_t contiguous;
+
+    /* one slot is always left unused, see the full check in ringbuf_put() */
+    space = (CC_ACCESS_NOW(uint8_t, r->get_ptr) - put_ptr - 1) & r->mask;
+    contiguous = (uint16_t) r->mask + 1 - put_ptr;
+
+    *ptr = &r->data[put_ptr];
+    return MIN(space, contiguous);
+}
+
+/*---------------------------------------------------------------------------*/
+void ringbuf_commit(struct ringbuf *r, const uint16_t len)
+{
+    /*
+     * the data in the span must be in memory before the consumer is
+     * allowed to see the new ->put_ptr.
+     */
+    CC_BARRIER();
+    CC_ACCESS_NOW(uint8_t, r->put_ptr) = (r->put_ptr + len) & r->mask;
+    ringbuf_account(r, len, 0, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+uint16_t ringbuf_read_span(struct ringbuf *r, uint8_t **ptr)
+{
+    uint8_t get_ptr = r->get_ptr;
+    uint8_t used;
+    uint16_t contiguous;
+
+    used = (CC_ACCESS_NOW(uint8_t, r->put_ptr) - get_ptr) & r->mask;
+    contiguous = (uint16_t) r->mask + 1 - get_ptr;
+
+    *ptr = &r->data[get_ptr];
+    return MIN(used, contiguous);
+}
+
+/*---------------------------------------------------------------------------*/
+void ringbuf_consume(struct ringbuf *r, const uint16_t len)
+{
+    /*
+     * the data in the span must be copied out before the producer is
+     * allowed to overwrite it.
+     */
+    CC_BARRIER();
+    CC_ACCESS_NOW(uint8_t, r->get_ptr) = (r->get_ptr + len) & r->mask;
+}
+
+/*---------------------------------------------------------------------------*/
+uint16_t ringbuf_put_n(struct ringbuf *r, const uint8_t *src, const uint16_t len)
+{
+    uint16_t done = 0;
+    uint16_t n;
+    uint8_t *p;
+
+    /* at most two iterations, one before and one after the wrap */
+    while (done < len) {
+        n = ringbuf_write_span(r, &p);
+        if (n == 0) {
+            break;
+        }
+        n = MIN(n, len - done);
+        memcpy(p, src + done, n);
+        ringbuf_commit(r, n);
+        done += n;
+    }
+
+    // a short write is not counted as a drop, the bytes stay with the
+    // caller which usually retries once the consumer has made room
+    if ((done < len) && (r->flags & RINGBUF_OVERWRITE)) {
+        // the buffer is full, older bytes are discarded one by one
+        while (done < len) {
+            ringbuf_put(r, src[done]);
+            done++;
+        }
+    }
+
+    return done;
+}
+
+/*---------------------------------------------------------------------------*/
+uint16_t ringbuf_get_n(struct ringbuf *r, uint8_t *dst, const uint16_t len)
+{
+    uint16_t done = 0;
+    uint16_t n;
+    uint8_t *p;
+
+    while (done < len) {
+        n = ringbuf_read_span(r, &p);
+        if (n == 0) {
+            break;
+        }
+        n = MIN(n, len - done);
+        memcpy(dst + done, p, n);
+        ringbuf_consume(r, n);
+        done += n;
+    }
+
+    return done;
+}
+
+#ifdef CONFIG_RINGBUF_STATS
+uint8_t ringbuf_get_stats(struct ringbuf *r, struct ringbuf_stats *s)
+{
+    uint8_t seq;
+    uint8_t retries = RINGBUF_STATS_RETRIES;
+
+    do {
+        seq = CC_ACCESS_NOW(uint8_t, r->stats_seq);
+        CC_BARRIER();
+        memcpy(s, &r->stats, sizeof(struct ringbuf_stats));
+        CC_BARRIER();
+        if (!(seq & 1) && (seq == CC_ACCESS_NOW(uint8_t, r->stats_seq))) {
+            return 1;
+        }
+    } while (--retries);
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+#endif
+void ringbuf16_init(struct ringbuf16 *r, uint8_t * dataptr, uint16_t size)
+{
+    r->data = dataptr;
+    r->mask = size - 1;
+    r->put_ptr = 0;
+    r->get_ptr = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t ringbuf16_put(struct ringbuf16 *r, uint8_t c)
+{
+    /* same as ringbuf_put(), the indices are 16-bit words which are
+       read and written atomically on the MSP430.
+     */
+    if (((r->put_ptr - r->get_ptr) & r->mask) == r->mask) {
+        return 0;
+    }
+    CC_ACCESS_NOW(uint8_t, r->data[r->put_ptr]) = c;
+    CC_ACCESS_NOW(uint16_t, r->put_ptr) = (r->put_ptr + 1) & r->mask;
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+uint8_t ringbuf16_get(struct ringbuf16 *r, uint8_t *c)
+{
+    if (((r->put_ptr - r->get_ptr) & r->mask) > 0) {
+        *c = CC_ACCESS_NOW(uint8_t, r->data[r->get_ptr]);
+        CC_ACCESS_NOW(uint16_t, r->get_ptr) = (r->get_ptr + 1) & r->mask;
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+uint16_t ringbuf16_size(struct ringbuf16 *r)
+{
+    return r->mask + 1;
+}
+
+/*---------------------------------------------------------------------------*/
+uint16_t ringbuf16_elements(struct ringbuf16 *r)
+{
+    return (r->put_ptr - r->get_ptr) & r->mask;
+}
+
+/*---------------------------------------------------------------------------*/
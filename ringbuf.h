@@ -56,6 +56,22 @@
 
 //#include "contiki.h"
 
+#ifdef CONFIG_RINGBUF_STATS
+/**
+ * \brief      Counters kept by the producer side of a ring buffer.
+ *
+ *             Only available if CONFIG_RINGBUF_STATS is defined.
+ *             Read them with ringbuf_get_stats().
+ *
+ */
+struct ringbuf_stats {
+    uint32_t puts;              /**< bytes written into the buffer */
+    uint16_t drops;             /**< bytes refused by ringbuf_put() because the buffer was full */
+    uint16_t overwrites;        /**< old bytes discarded in RINGBUF_OVERWRITE mode */
+    uint8_t hwm;                /**< high-water mark of ringbuf_elements() */
+};
+#endif
+
 /**
  * \brief      Structure that holds the state of a ring buffer.
  *
@@ -71,8 +87,18 @@ struct ringbuf {
 
     /* XXX these must be 8-bit quantities to avoid race conditions. */
     uint8_t put_ptr, get_ptr;
+
+    uint8_t flags;
+#ifdef CONFIG_RINGBUF_STATS
+    /* odd while the producer is updating the counters */
+    uint8_t stats_seq;
+    struct ringbuf_stats stats;
+#endif
 };
 
+/** Overwrite the oldest byte instead of refusing new ones when the buffer is full. */
+#define RINGBUF_OVERWRITE 0x1
+
 /**
  * \brief      Initialize a ring buffer
  * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
@@ -88,6 +114,29 @@ struct ringbuf {
  */
 void ringbuf_init(struct ringbuf *r, uint8_t * a, uint16_t size_power_of_two);
 
+/**
+ * \brief      Set the policy applied when a byte is written into a full ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param flags Zero to refuse new bytes (the default) or RINGBUF_OVERWRITE
+ *
+ *             In RINGBUF_OVERWRITE mode the producer discards the
+ *             oldest byte to make room for the new one, so it also
+ *             writes ->get_ptr. This is safe as long as the consumer
+ *             cannot interrupt the producer (e.g. an ISR producer and
+ *             a main loop consumer). If the consumer runs in an
+ *             interrupt handler it might get a byte twice when it
+ *             fires in the middle of an overwrite.
+ *
+ *             The span API (ringbuf_read_span()/ringbuf_consume())
+ *             and ringbuf_get_n() are not safe in this mode: the
+ *             producer can move ->get_ptr while the reader is still
+ *             copying out of the span, so the reader returns bytes
+ *             that were already overwritten and its consume moves
+ *             ->get_ptr past data it never saw. Use ringbuf_get().
+ *
+ */
+void ringbuf_set_policy(struct ringbuf *r, const uint8_t flags);
+
 /**
  * \brief      Insert a byte into the ring buffer
  * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
@@ -96,7 +145,8 @@ void ringbuf_init(struct ringbuf *r, uint8_t * a, uint16_t size_power_of_two);
  *
  *             This function inserts a byte into the ring buffer. It
  *             is safe to call this function from an interrupt
- *             handler.
+ *             handler. In RINGBUF_OVERWRITE mode the byte is always
+ *             written.
  *
  */
 uint8_t ringbuf_put(struct ringbuf *r, uint8_t c);
@@ -117,9 +167,9 @@ uint8_t ringbuf_get(struct ringbuf *r, uint8_t *c);
 /**
  * \brief      Get the size of a ring buffer
  * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
- * \return     The size of the buffer.
+ * \return     The size of the buffer, 256 does not fit a uint8_t
  */
-uint8_t ringbuf_size(struct ringbuf *r);
+uint16_t ringbuf_size(struct ringbuf *r);
 
 /**
  * \brief      Get the number of elements currently in the ring buffer
@@ -128,6 +178,151 @@ uint8_t ringbuf_size(struct ringbuf *r);
  */
 uint8_t ringbuf_elements(struct ringbuf *r);
 
+/**
+ * \brief      Insert multiple bytes into the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param src  A pointer to the bytes to be written to the buffer
+ * \param len  The number of bytes to be written
+ * \return     The number of bytes that were written, which is less than len if the buffer got full.
+ *
+ *             This function copies as many bytes as fit into the
+ *             ring buffer using at most two memcpy() calls. It is
+ *             safe to call this function from the producer side
+ *             while the consumer runs in an interrupt handler. The
+ *             bytes that did not fit are left to the caller and are
+ *             not counted in ringbuf_stats.drops.
+ *
+ */
+uint16_t ringbuf_put_n(struct ringbuf *r, const uint8_t *src, const uint16_t len);
+
+/**
+ * \brief      Get multiple bytes from the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param dst  A pointer to the area the bytes are copied to
+ * \param len  The maximum number of bytes to be copied
+ * \return     The number of bytes that were copied, zero if the buffer was empty.
+ */
+uint16_t ringbuf_get_n(struct ringbuf *r, uint8_t *dst, const uint16_t len);
+
+/**
+ * \brief      Get the largest contiguous region of free space in the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param ptr  Set to the start of the free region inside the backing array
+ * \return     The number of bytes that can be written at *ptr
+ *
+ *             The producer can fill the region directly (memcpy or
+ *             DMA) and must then publish the new data with
+ *             ringbuf_commit(). The region does not wrap around the
+ *             end of the backing array, so a second call might be
+ *             needed after a commit to use all the free space.
+ *
+ */
+uint16_t ringbuf_write_span(struct ringbuf *r, uint8_t **ptr);
+
+/**
+ * \brief      Publish bytes written into a region obtained from ringbuf_write_span()
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param len  The number of bytes written, at most the value returned by ringbuf_write_span()
+ */
+void ringbuf_commit(struct ringbuf *r, const uint16_t len);
+
+/**
+ * \brief      Get the largest contiguous region of data in the ring buffer
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param ptr  Set to the oldest byte in the buffer
+ * \return     The number of bytes that can be read at *ptr
+ *
+ *             The data stays in the buffer and is not overwritten by
+ *             the producer until it is released by ringbuf_consume().
+ *
+ */
+uint16_t ringbuf_read_span(struct ringbuf *r, uint8_t **ptr);
+
+/**
+ * \brief      Release bytes read from a region obtained from ringbuf_read_span()
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param len  The number of bytes to release, at most the value returned by ringbuf_read_span()
+ */
+void ringbuf_consume(struct ringbuf *r, const uint16_t len);
+
+#ifdef CONFIG_RINGBUF_STATS
+/**
+ * \brief      Take a snapshot of the ring buffer counters
+ * \param r    A pointer to a struct ringbuf to hold the state of the ring buffer
+ * \param s    A pointer to the struct the counters are copied to
+ * \return     Non-zero if the snapshot is consistent, zero if the producer kept updating the counters
+ *
+ *             The producer is not stopped while the counters are
+ *             copied, the copy is simply retried if it was updated
+ *             meanwhile. Since the retry is bounded this function is
+ *             also safe to call from an interrupt handler that
+ *             preempts the producer.
+ *
+ */
+uint8_t ringbuf_get_stats(struct ringbuf *r, struct ringbuf_stats *s);
+#endif
+
+/**
+ * \brief      Structure that holds the state of a ring buffer with 16-bit indices.
+ *
+ *             Same as struct ringbuf, but the indices are 16-bit
+ *             quantities so the buffer can be larger than 256 bytes.
+ *             Accesses to 16-bit words are atomic on the MSP430, so
+ *             the put/get pair remains safe to use between an
+ *             interrupt handler and the main loop. This struct is an
+ *             opaque structure with no user-visible elements.
+ *
+ */
+struct ringbuf16 {
+    uint8_t *data;
+    uint16_t mask;
+
+    /* XXX these must be 16-bit quantities (the native word size) to avoid race conditions. */
+    uint16_t put_ptr, get_ptr;
+};
+
+/**
+ * \brief      Initialize a 16-bit index ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param a    A pointer to an array to hold the data in the buffer
+ * \param size_power_of_two The size of the ring buffer, which must be a power of two
+ *
+ *             The size of the ring buffer must be a power of two and
+ *             cannot be larger than 32768 bytes.
+ *
+ */
+void ringbuf16_init(struct ringbuf16 *r, uint8_t * a, uint16_t size_power_of_two);
+
+/**
+ * \brief      Insert a byte into the 16-bit index ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param c    The byte to be written to the buffer
+ * \return     Non-zero if there data could be written, or zero if the buffer was full.
+ */
+uint8_t ringbuf16_put(struct ringbuf16 *r, uint8_t c);
+
+/**
+ * \brief      Get a byte from the 16-bit index ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \param c    A pointer to the byte retrieved from the ring buffer
+ * \return     Non-zero if there was data available on the ring buffer, or zero if the buffer was empty
+ */
+uint8_t ringbuf16_get(struct ringbuf16 *r, uint8_t *c);
+
+/**
+ * \brief      Get the size of a 16-bit index ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \return     The size of the buffer.
+ */
+uint16_t ringbuf16_size(struct ringbuf16 *r);
+
+/**
+ * \brief      Get the number of elements currently in the 16-bit index ring buffer
+ * \param r    A pointer to a struct ringbuf16 to hold the state of the ring buffer
+ * \return     The number of elements in the buffer.
+ */
+uint16_t ringbuf16_elements(struct ringbuf16 *r);
+
 #endif                          /* RINGBUF_H_ */
 
 /** @}*/
@@ -23,41 +23,48 @@
 
 uint8_t TCA6408_read(const uint16_t usci_base_addr, const uint8_t slave_addr, uint8_t * data, const uint8_t addr)
 {
-    i2c_package_t pkg;
+    i2c_package_t pkg[2];
     uint8_t i2c_buf[1];
-#ifndef HARDWARE_I2C
+#ifdef HARDWARE_I2C
+    i2c_transfer_t t;
+#else
     uint8_t rv = EXIT_FAILURE;
 #endif
 
     i2c_buf[0] = addr;
 
     // first seek to the required address
-    pkg.slave_addr = slave_addr;
-    pkg.addr = NULL;
-    pkg.addr_len = 0;
-    pkg.data = i2c_buf;
-    pkg.data_len = 1;
-    pkg.options = I2C_WRITE;
+    pkg[0].slave_addr = slave_addr;
+    pkg[0].addr = NULL;
+    pkg[0].addr_len = 0;
+    pkg[0].data = i2c_buf;
+    pkg[0].data_len = 1;
+    pkg[0].options = I2C_WRITE;
+
+    // and now do the actual read
+    pkg[1].slave_addr = slave_addr;
+    pkg[1].addr = NULL;
+    pkg[1].addr_len = 0;
+    pkg[1].data = data;
+    pkg[1].data_len = 1;
+    pkg[1].options = I2C_READ | I2C_LAST_NAK;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    // both packages are sent as a single transaction
+    t.pkg = pkg;
+    t.pkg_cnt = 2;
+    t.callback = NULL;
+    if (i2c_transfer_run(usci_base_addr, &t) != I2C_IDLE) {
+        return EXIT_FAILURE;
+    }
 #else
-    rv = i2cm_transfer(&pkg);
+    rv = i2cm_transfer(&pkg[0]);
 
     if (rv != I2C_ACK) {
         return EXIT_FAILURE;
     }
-#endif
-
-    // and now do the actual read
-    pkg.data = data;
-    pkg.data_len = 1;
-    pkg.options = I2C_READ | I2C_LAST_NAK;
 
-#ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
-#else
-    rv = i2cm_transfer(&pkg);
+    rv = i2cm_transfer(&pkg[1]);
     if (rv != I2C_ACK) {
         return EXIT_FAILURE;
     }
@@ -84,7 +91,7 @@ uint8_t TCA6408_write(const uint16_t usci_base_addr, const uint8_t slave_addr, u
     pkg.options = I2C_WRITE;
 
 #ifdef HARDWARE_I2C
-    i2c_transfer_start(usci_base_addr, &pkg, NULL);
+    i2c_transfer_run_pkg(usci_base_addr, &pkg);
 #else
     rv = i2cm_transfer(&pkg);
     if (rv != I2C_ACK) {
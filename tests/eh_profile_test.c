@@ -0,0 +1,151 @@
+// host unit test for the event handler callback profiling
+//
+// the profiling timer is replaced by a counter that the callbacks advance by a
+// known number of cycles. every wrap of the 16bit counter raises the overflow
+// flag, and the simulated overflow interrupt either runs right away or is left
+// pending to check the case where the timer is read before the ISR got a chance.
+//
+// license:     BSD
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event_handler.h"
+
+volatile uint16_t stub_timer;
+volatile uint8_t stub_timer_ifg;
+
+static int failed;
+static char report[256];
+static uint16_t report_len;
+
+// let the timer run for cycles ticks. with isr set, overflows are counted as they happen
+static void stub_timer_run(uint32_t cycles, const uint8_t isr)
+{
+    while (cycles--) {
+        stub_timer++;
+        if (stub_timer == 0) {
+            stub_timer_ifg = 1;
+            if (isr) {
+                stub_timer_ifg = 0;
+                eh_profile_timer_overflow();
+            }
+        }
+    }
+}
+
+// the overflow interrupt that was held back
+static void stub_timer_isr(void)
+{
+    if (stub_timer_ifg) {
+        stub_timer_ifg = 0;
+        eh_profile_timer_overflow();
+    }
+}
+
+static void cb_short(const uint32_t ev)
+{
+    (void)ev;
+    stub_timer_run(100, 1);
+}
+
+static void cb_long(const uint32_t ev)
+{
+    (void)ev;
+    stub_timer_run(70000, 1);
+}
+
+static void cb_very_long(const uint32_t ev)
+{
+    (void)ev;
+    stub_timer_run(200000, 1);
+}
+
+static void cb_pending(const uint32_t ev)
+{
+    (void)ev;
+    // the timer wraps, but the ISR only runs after the callback was measured
+    stub_timer_run(40, 0);
+}
+
+static uint16_t report_print(const char *str)
+{
+    uint16_t len = strlen(str);
+
+    if (report_len + len < sizeof(report)) {
+        memcpy(report + report_len, str, len + 1);
+        report_len += len;
+    }
+    return len;
+}
+
+static void expect(const char *what, const uint32_t got, const uint32_t exp)
+{
+    if (got != exp) {
+        printf("FAIL %s: got %lu, expected %lu\n", what, (unsigned long)got, (unsigned long)exp);
+        failed = 1;
+    }
+}
+
+static struct event_handler *find(void (*cb) (const uint32_t evid))
+{
+    struct event_handler *p = event_handler_getp();
+    uint8_t c;
+
+    for (c = 0; c < EH_MAX; c++) {
+        if (p[c].callback == cb) {
+            return &p[c];
+        }
+    }
+    printf("FAIL handler not registered\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(void)
+{
+    struct event_handler *p;
+
+    eh_init();
+    eh_profile_init();
+    eh_register(cb_short, 0x1);
+    eh_register(cb_long, 0x2);
+    eh_register(cb_very_long, 0x4);
+    eh_register(cb_pending, 0x8);
+
+    eh_exec(0x1);
+    eh_exec(0x1);
+    p = find(cb_short);
+    expect("short count", p->prof_cnt, 2);
+    expect("short total", p->prof_total, 200);
+    expect("short max", p->prof_max, 100);
+
+    // longer than one timer period
+    eh_exec(0x2);
+    expect("long max", find(cb_long)->prof_max, 70000);
+
+    // several overflows
+    eh_exec(0x4);
+    expect("very long max", find(cb_very_long)->prof_max, 200000);
+
+    // the overflow is still pending when the end time is read
+    stub_timer = 0xfff0;
+    eh_exec(0x8);
+    stub_timer_isr();
+    expect("pending overflow max", find(cb_pending)->prof_max, 40);
+
+    // a short callback measured right after the held back overflow was counted
+    eh_exec(0x1);
+    expect("short max after overflow", find(cb_short)->prof_max, 100);
+
+    eh_profile_report(report_print);
+    if (!strstr(report, " max 200000")) {
+        printf("FAIL report: %s\n", report);
+        failed = 1;
+    }
+
+    eh_profile_reset();
+    expect("reset", find(cb_very_long)->prof_max, 0);
+
+    printf("eh_profile: %s\n", failed ? "FAIL" : "ok");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+// host stress test for the ringbuf16 family
+//
+// a producer thread plays the part of the RX ISR and pushes a running byte
+// sequence into the ring, a consumer thread plays the main loop and drains it.
+// a byte the producer can not store because the ring is full is counted as
+// lost and the producer moves on, just like the ISR would. the consumer checks
+// that what it reads is exactly the sequence of bytes that were stored.
+//
+// usage: ringbuf16_stress [ring size] [seconds]
+//
+// license:     BSD
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ringbuf.h"
+
+static struct ringbuf16 rb;
+static uint8_t *rb_mem;
+static double duration;
+static uint64_t pushed;
+static uint64_t lost;
+static uint64_t received;
+static uint64_t errors;
+static volatile int producer_done;
+
+static double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void *producer(void *arg)
+{
+    double end = now() + duration;
+    uint16_t i;
+    uint8_t seq = 0;
+
+    (void)arg;
+    do {
+        for (i = 0; i < 4096; i++) {
+            if (ringbuf16_put(&rb, seq)) {
+                seq++;
+            } else {
+                lost++;
+                // give the consumer a chance on hosts with few cores
+                sched_yield();
+            }
+        }
+        pushed += 4096;
+    } while (now() < end);
+    producer_done = 1;
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    uint8_t c;
+    uint8_t seq = 0;
+
+    (void)arg;
+    for (;;) {
+        if (ringbuf16_get(&rb, &c)) {
+            if (c != seq) {
+                errors++;
+                seq = c;
+            }
+            seq++;
+            received++;
+        } else if (producer_done && !ringbuf16_elements(&rb)) {
+            break;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t p, c;
+    uint16_t size = 4096;
+    double t0, dt;
+
+    duration = 1.0;
+    if (argc > 1) {
+        size = strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        duration = strtod(argv[2], NULL);
+    }
+    if (!size || (size & (size - 1))) {
+        fprintf(stderr, "ring size must be a power of two\n");
+        return EXIT_FAILURE;
+    }
+
+    rb_mem = malloc(size);
+    if (!rb_mem) {
+        return EXIT_FAILURE;
+    }
+    ringbuf16_init(&rb, rb_mem, size);
+    if ((ringbuf16_size(&rb) != size) || ringbuf16_elements(&rb)) {
+        fprintf(stderr, "init failed\n");
+        return EXIT_FAILURE;
+    }
+
+    t0 = now();
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    dt = now() - t0;
+
+    printf("ring %5u bytes: pushed %" PRIu64 ", received %" PRIu64 ", lost %" PRIu64
+           ", sequence errors %" PRIu64 ", %.0f bytes/s\n",
+           size, pushed, received, lost, errors, received / dt);
+
+    if (errors || (received + lost != pushed)) {
+        printf("FAIL\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
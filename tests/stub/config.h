@@ -0,0 +1,3 @@
+// project configuration for the host tests, the modules under test need no options
+//
+// license:     BSD
@@ -0,0 +1,24 @@
+// minimal host stand-in for <msp430.h>, enough for the modules under test
+//
+// license:     BSD
+
+#ifndef __STUB_MSP430_H__
+#define __STUB_MSP430_H__
+
+#include <stdint.h>
+
+#define GIE        0x0008
+#define LPM0_bits  0x0010
+#define LPM3_bits  0x00d0
+#define LPM4_bits  0x00f0
+
+// the host tests run single threaded, interrupts are simulated by direct calls
+static inline uint16_t __get_interrupt_state(void) { return 0; }
+static inline void __set_interrupt_state(uint16_t s) { (void)s; }
+static inline void __disable_interrupt(void) { }
+static inline void __enable_interrupt(void) { }
+static inline void __no_operation(void) { }
+static inline void __bis_SR_register(uint16_t x) { (void)x; }
+static inline void __bic_SR_register_on_exit(uint16_t x) { (void)x; }
+
+#endif
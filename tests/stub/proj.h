@@ -0,0 +1,20 @@
+// project configuration for the host tests
+//
+// license:     BSD
+
+#ifndef __PROJ_H__
+#define __PROJ_H__
+
+#include <inttypes.h>
+
+#define CONFIG_EH_PROFILE
+
+// stub for the profiling timer, see eh_profile_test.c
+extern volatile uint16_t stub_timer;
+extern volatile uint8_t stub_timer_ifg;
+
+#define EH_PROFILE_TIMER_INIT()         do { stub_timer = 0; stub_timer_ifg = 0; } while (0)
+#define EH_PROFILE_TIMER_READ()         stub_timer
+#define EH_PROFILE_TIMER_OVF_PENDING()  stub_timer_ifg
+
+#endif
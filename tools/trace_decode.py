@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+
+# decoder for the binary trace frames sent by trace.c
+#
+# reads the raw UART stream from a file or a serial port, splits it at the
+# 0x00 delimiters, undoes the COBS encoding, checks the CRC16 trailer and
+# prints every record using a map of event ids to format strings.
+#
+# the map file holds one event per line, '#' starts a comment:
+#
+#   1   adc sample ch={0} val={1}
+#   2   i2c nack addr=0x{0:02x}
+#   0x10 rx overrun
+#
+# records with unknown ids are printed raw. the 16bit timestamps are unwrapped
+# into a running tick count, which is also shown in seconds if --clock is given.
+# frames that are not trace frames (other frame.c users) are skipped.
+#
+# usage:
+#   trace_decode.py -m events.map /dev/ttyUSB0
+#   trace_decode.py -m events.map --clock 32768 capture.bin
+#
+# license:     BSD
+
+import argparse
+import struct
+import sys
+
+TRACE_FRAME_TYPE = 0x54
+REC_FMT = '<HBBHH'
+REC_SZ = struct.calcsize(REC_FMT)
+
+
+def crc16(data, crc=0xffff):
+    for c in data:
+        crc ^= c << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xffff
+    return crc
+
+
+def cobs_decode(enc):
+    out = bytearray()
+    i = 0
+    while i < len(enc):
+        code = enc[i]
+        if code == 0 or i + code > len(enc):
+            return None
+        out += enc[i + 1:i + code]
+        i += code
+        if code != 0xff and i < len(enc):
+            out.append(0)
+    return bytes(out)
+
+
+def load_map(path):
+    events = {}
+    if not path:
+        return events
+    with open(path) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            parts = line.split(None, 1)
+            events[int(parts[0], 0)] = parts[1] if len(parts) > 1 else parts[0]
+    return events
+
+
+class Decoder:
+    def __init__(self, events, clock):
+        self.events = events
+        self.clock = clock
+        self.last_ts = None
+        self.ticks = 0
+
+    def timestamp(self, ts):
+        if self.last_ts is not None:
+            self.ticks += (ts - self.last_ts) & 0xffff
+        self.last_ts = ts
+        if self.clock:
+            return '%12.6f' % (self.ticks / self.clock)
+        return '%10d' % self.ticks
+
+    def record(self, rec):
+        ts, eid, argc, a0, a1 = struct.unpack(REC_FMT, rec)
+        args = (a0, a1)[:argc]
+        fmt = self.events.get(eid)
+        if fmt is None:
+            text = 'id=%d %s' % (eid, ' '.join('0x%04x' % a for a in args))
+        else:
+            try:
+                text = fmt.format(*args)
+            except (IndexError, ValueError):
+                text = '%s %r' % (fmt, args)
+        print('%s  %s' % (self.timestamp(ts), text))
+
+    def frame(self, raw):
+        data = cobs_decode(raw)
+        if data is None or len(data) < 2:
+            print('# malformed frame', file=sys.stderr)
+            return
+        if crc16(data) != 0:
+            print('# crc error', file=sys.stderr)
+            return
+        payload = data[:-2]
+        if len(payload) < 3 or payload[0] != TRACE_FRAME_TYPE:
+            return
+        dropped = payload[1] | (payload[2] << 8)
+        if dropped:
+            print('# %d records dropped' % dropped)
+        body = payload[3:]
+        for i in range(0, len(body) - REC_SZ + 1, REC_SZ):
+            self.record(body[i:i + REC_SZ])
+
+
+def main():
+    ap = argparse.ArgumentParser(description='decode trace frames')
+    ap.add_argument('-m', '--map', help='event id to format string map')
+    ap.add_argument('-c', '--clock', type=float, default=0,
+                    help='timestamp timer frequency in Hz')
+    ap.add_argument('input', nargs='?', default='-',
+                    help='capture file or serial device, default stdin')
+    args = ap.parse_args()
+
+    dec = Decoder(load_map(args.map), args.clock)
+    src = sys.stdin.buffer if args.input == '-' else open(args.input, 'rb', buffering=0)
+
+    buf = bytearray()
+    while True:
+        chunk = src.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            end = buf.find(0)
+            if end < 0:
+                break
+            if end:
+                dec.frame(bytes(buf[:end]))
+            del buf[:end + 1]
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,127 @@
+// binary trace records with deferred formatting
+//
+// license:     BSD
+
+#include "config.h"
+#ifdef CONFIG_TRACE
+
+#include <msp430.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include "recqueue.h"
+#include "frame.h"
+#include "trace.h"
+#if defined(UART0_TX_USES_IRQ) || defined(UART0_TX_USES_DMA)
+#include "ringbuf.h"
+#include "uart0.h"
+#endif
+
+#ifdef TRACE_TIMER_USES_TA
+#ifdef CONFIG_EH_TIMER
+#include "eh_timer.h"
+#if EH_TIMER_TA == TRACE_TIMER_TA
+#error "trace and eh_timer use the same Timer_A, change TRACE_TIMER_TA or EH_TIMER_TA in config.h"
+#endif
+#endif
+#ifdef CONFIG_AUTOBAUD
+#include "autobaud.h"
+#if AUTOBAUD_TA == TRACE_TIMER_TA
+#error "trace and autobaud use the same Timer_A, change TRACE_TIMER_TA or AUTOBAUD_TA in config.h"
+#endif
+#endif
+#endif
+
+// COBS code bytes, CRC and delimiter added to a payload shorter than 254 bytes
+#define TRACE_FRAME_OVERHEAD  5
+// frame type and dropped counter
+#define   TRACE_HDR_SZ  3
+
+static struct recq trace_q;
+static struct trace_rec trace_mem[TRACE_REC_CNT] TRACE_ATTR;
+static uint16_t trace_dropped;
+static struct frame_enc trace_enc;
+
+void trace_init(void)
+{
+    recq_init(&trace_q, trace_mem, sizeof(struct trace_rec), TRACE_REC_CNT);
+    trace_dropped = 0;
+    TRACE_TIMER_INIT();
+}
+
+void trace_rec(const uint8_t id, const uint8_t argc, const uint16_t a0, const uint16_t a1)
+{
+    struct trace_rec *r;
+    uint16_t state;
+
+    // ISRs can be producers too
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    r = (struct trace_rec *)recq_alloc(&trace_q);
+    if (r) {
+        r->ts = TRACE_TIMESTAMP();
+        r->id = id;
+        r->argc = argc;
+        r->arg[0] = a0;
+        r->arg[1] = a1;
+        recq_push(&trace_q);
+    } else if (trace_dropped != 0xffff) {
+        trace_dropped++;
+    }
+    __set_interrupt_state(state);
+}
+
+uint8_t trace_drain(frame_sink_t sink, void *ctx, const uint8_t max)
+{
+    uint8_t hdr[TRACE_HDR_SZ];
+    uint16_t n, c;
+    uint16_t state;
+
+    n = recq_elements(&trace_q);
+    if (n > max) {
+        n = max;
+    }
+    if (!n) {
+        return 0;
+    }
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    hdr[1] = trace_dropped & 0xff;
+    hdr[2] = trace_dropped >> 8;
+    trace_dropped = 0;
+    __set_interrupt_state(state);
+    hdr[0] = TRACE_FRAME_TYPE;
+
+    // the records are encoded straight out of the queue
+    frame_enc_begin(&trace_enc, sink, ctx);
+    frame_enc_write(&trace_enc, hdr, TRACE_HDR_SZ);
+    for (c = 0; c < n; c++) {
+        frame_enc_write(&trace_enc, recq_peek(&trace_q), sizeof(struct trace_rec));
+        recq_pop(&trace_q);
+    }
+    frame_enc_end(&trace_enc);
+
+    return n;
+}
+
+#if defined(UART0_TX_USES_IRQ) || defined(UART0_TX_USES_DMA)
+void trace_drain_uart0(void)
+{
+    struct ringbuf *tx = uart0_get_tx_ringbuf();
+    uint16_t room;
+
+    if (ringbuf_elements(tx)) {
+        // the line is busy
+        return;
+    }
+
+    room = ringbuf_size(tx) - 1;
+    if (room <= TRACE_FRAME_OVERHEAD + TRACE_HDR_SZ) {
+        return;
+    }
+    room -= TRACE_FRAME_OVERHEAD + TRACE_HDR_SZ;
+    trace_drain(uart0_tx_sink, NULL, room / sizeof(struct trace_rec));
+}
+#endif
+
+#endif
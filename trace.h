@@ -0,0 +1,114 @@
+// binary trace records with deferred formatting
+//
+// TRACE0/1/2() store an 8 byte record (timestamp, event id, up to two 16bit
+// arguments) into a record queue. nothing is formatted on the target. the
+// queue is drained later, from the main loop, as COBS frames (see frame.h)
+// once the UART is idle. tools/trace_decode.py turns the frames back into text
+// on the host.
+//
+// frame payload, little endian:
+//
+//   uint8_t   TRACE_FRAME_TYPE
+//   uint16_t  number of records dropped because the queue was full
+//   struct trace_rec [n]
+//
+// define CONFIG_TRACE in config.h to enable this module. otherwise the TRACE
+// macros compile to nothing. the following can be overridden in config.h:
+//
+//   TRACE_REC_CNT        number of records in the queue, power of two (default 64)
+//   TRACE_ATTR           attributes for the queue storage, for example to place it in FRAM
+//   TRACE_TIMER_TA       Timer_A instance used for the timestamps (default 3, ACLK, continuous)
+//   TRACE_TIMER_INIT()   starts the timestamp timer, for a timer other than a Timer_A
+//   TRACE_TIMESTAMP()    reads the timestamp, has to be overridden along with TRACE_TIMER_INIT()
+//
+// Timer_B0 is left alone since the event handler profiling (CONFIG_EH_PROFILE) runs it
+// from SMCLK. sharing the Timer_A instance with eh_timer or autobaud is caught at build time.
+//
+// license:     BSD
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+#include "cc.h"
+#include "frame.h"
+
+#define TRACE_FRAME_TYPE  0x54
+
+#ifndef TRACE_REC_CNT
+#define TRACE_REC_CNT  64
+#endif
+
+#ifndef TRACE_ATTR
+#define TRACE_ATTR
+#endif
+
+#ifndef TRACE_TIMER_TA
+#define TRACE_TIMER_TA  3
+#endif
+
+#ifndef TRACE_TIMER_INIT
+#define TRACE_TIMER_USES_TA
+#define TRACE_TIMER_INIT() do { CC_CONCAT_EXT_3(TA, TRACE_TIMER_TA, CTL) = TASSEL__ACLK | MC__CONTINUOUS | TACLR; } while (0)
+#endif
+
+#ifndef TRACE_TIMESTAMP
+#define TRACE_TIMESTAMP() CC_CONCAT_EXT_3(TA, TRACE_TIMER_TA, R)
+#endif
+
+struct trace_rec {
+    uint16_t ts;
+    uint8_t id;
+    uint8_t argc;
+    uint16_t arg[2];
+};
+
+#ifdef CONFIG_TRACE
+
+#define            TRACE0(id)  trace_rec(id, 0, 0, 0)
+#define         TRACE1(id, a)  trace_rec(id, 1, a, 0)
+#define      TRACE2(id, a, b)  trace_rec(id, 2, a, b)
+
+#else
+
+#define            TRACE0(id)  do { } while (0)
+#define         TRACE1(id, a)  do { } while (0)
+#define      TRACE2(id, a, b)  do { } while (0)
+
+#endif
+
+/*!
+	\brief initialize the record queue and start the timestamp timer
+*/
+void trace_init(void);
+
+/*!
+	\brief store a record, use the TRACE macros instead
+    \details safe to call from both ISRs and the main loop
+*/
+void trace_rec(const uint8_t id, const uint8_t argc, const uint16_t a0, const uint16_t a1);
+
+/*!
+	\brief send up to max records as one frame
+	\param sink  output function, for example uart0_tx_sink()
+	\param ctx   opaque pointer handed to the sink
+	\return number of records sent
+*/
+uint8_t trace_drain(frame_sink_t sink, void *ctx, const uint8_t max);
+
+/*!
+	\brief send a frame over uart0 if its TX ring buffer is empty (UART0_TX_USES_IRQ or _DMA)
+    \details the frame is sized to fit into the TX ring buffer, so the call never
+             blocks. meant to be called from the main loop before going to sleep
+*/
+void trace_drain_uart0(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,328 @@
+// unified interrupt driven driver for the eUSCI_A UART modules
+//
+// license:     BSD
+
+#include <msp430.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driverlib.h"
+#include "config.h"
+#include "clock.h"
+#include "uart_config.h"
+#include "uart.h"
+#ifdef CONFIG_FMT
+#include <stdarg.h>
+#include "fmt.h"
+#endif
+
+#if defined(UART_USES_UCA0) || defined(UART_USES_UCA1) || defined(UART_USES_UCA2) || defined(UART_USES_UCA3)
+
+#define UART_REG16(base, ofs)  HWREG16((base) + (ofs))
+
+#ifdef UART_USES_UCA0
+uart_t uart_a0 = {.baseAddress = EUSCI_A0_BASE };
+#endif
+#ifdef UART_USES_UCA1
+uart_t uart_a1 = {.baseAddress = EUSCI_A1_BASE };
+#endif
+#ifdef UART_USES_UCA2
+uart_t uart_a2 = {.baseAddress = EUSCI_A2_BASE };
+#endif
+#ifdef UART_USES_UCA3
+uart_t uart_a3 = {.baseAddress = EUSCI_A3_BASE };
+#endif
+
+void uart_init(uart_t * dev, uint8_t * rx_buf, const uint16_t rx_sz, uint8_t * tx_buf,
+               const uint16_t tx_sz)
+{
+    uint16_t base = dev->baseAddress;
+
+    UART_REG16(base, OFS_UCAxCTLW0) = UCSWRST;  // put eUSCI state machine in reset
+
+// UC_CTLW0 and the BRW_/MCTLW_ tables are only available if SMCLK_FREQ is known
+#if defined(UC_CTLW0) && (defined(BAUD_9600) || defined(BAUD_19200) || defined(BAUD_38400) \
+    || defined(BAUD_57600) || defined(BAUD_115200) || defined(BAUD_230400) || defined(BAUD_460800))
+    UART_REG16(base, OFS_UCAxCTLW0) |= UC_CTLW0;
+
+    #if defined(BAUD_9600)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_9600_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_9600_BAUD;
+    #elif defined(BAUD_19200)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_19200_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_19200_BAUD;
+    #elif defined(BAUD_38400)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_38400_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_38400_BAUD;
+    #elif defined(BAUD_57600)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_57600_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_57600_BAUD;
+    #elif defined(BAUD_115200)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_115200_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_115200_BAUD;
+    #elif defined(BAUD_230400)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_230400_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_230400_BAUD;
+    #elif defined(BAUD_460800)
+    UART_REG16(base, OFS_UCAxBRW) = BRW_460800_BAUD;
+    UART_REG16(base, OFS_UCAxMCTLW) = MCTLW_460800_BAUD;
+    #endif
+#else
+    // a 9600 BAUD based on ACLK
+    UART_REG16(base, OFS_UCAxCTLW0) |= UCSSEL__ACLK;
+    UART_REG16(base, OFS_UCAxBRW) = 3;
+    UART_REG16(base, OFS_UCAxMCTLW) = 0x9200;
+#endif
+
+    ringbuf_init(&dev->rbrx, rx_buf, rx_sz);
+    ringbuf_init(&dev->rbtx, tx_buf, tx_sz);
+    dev->rx_irq_handler = uart_rx_ringbuf_handler;
+    dev->tx_busy = 0;
+    dev->last_event = UART_EV_NULL;
+    memset(&dev->stats, 0, sizeof(struct uart_stats));
+
+    UART_REG16(base, OFS_UCAxCTLW0) &= ~UCSWRST;        // Initialize eUSCI
+    UART_REG16(base, OFS_UCAxIE) |= UCRXIE | UCTXIE;
+}
+
+uint8_t uart_rx_ringbuf_handler(uart_t * dev, const uint8_t c)
+{
+    if (!ringbuf_put(&dev->rbrx, c)) {
+        UART_STATS_INC16(dev->stats.rx_drop);
+    }
+    UART_STATS_RX_PEAK(dev->stats, ringbuf_elements(&dev->rbrx));
+
+    if (c == 0x0d) {
+        return 1;
+    }
+
+    return 0;
+}
+
+void uart_set_rx_irq_handler(uart_t * dev, uint8_t (*input) (uart_t * dev, const uint8_t c))
+{
+    dev->rx_irq_handler = input;
+}
+
+uint8_t uart_set_baud(uart_t * dev, const uint32_t clk, const uint32_t baud)
+{
+    uint16_t base = dev->baseAddress;
+    struct uart_baud b;
+    uint16_t ie, ctlw0;
+
+    if (uart_baud_calc(clk, baud, &b) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    // the clock source and the frame format stay as they are.
+    // the interrupt enable bits are cleared while the eUSCI is in reset
+    ie = UART_REG16(base, OFS_UCAxIE);
+    ctlw0 = UART_REG16(base, OFS_UCAxCTLW0) & ~UCSWRST;
+    UART_REG16(base, OFS_UCAxCTLW0) = ctlw0 | UCSWRST;
+    UART_REG16(base, OFS_UCAxBRW) = b.brw;
+    UART_REG16(base, OFS_UCAxMCTLW) = b.mctlw;
+    UART_REG16(base, OFS_UCAxCTLW0) = ctlw0;
+    UART_REG16(base, OFS_UCAxIE) = ie;
+
+    return EXIT_SUCCESS;
+}
+
+void uart_get_stats(uart_t * dev, struct uart_stats *s)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    memcpy(s, &dev->stats, sizeof(struct uart_stats));
+    __set_interrupt_state(state);
+}
+
+void uart_rst_stats(uart_t * dev)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    memset(&dev->stats, 0, sizeof(struct uart_stats));
+    __set_interrupt_state(state);
+}
+
+uint8_t uart_get_event(uart_t * dev)
+{
+    return dev->last_event;
+}
+
+void uart_rst_event(uart_t * dev)
+{
+    dev->last_event = UART_EV_NULL;
+}
+
+struct ringbuf *uart_get_rx_ringbuf(uart_t * dev)
+{
+    return &dev->rbrx;
+}
+
+static void uart_tx_activate(uart_t * dev)
+{
+    uint8_t t;
+    uint16_t state;
+
+    if (!dev->tx_busy) {
+        if (ringbuf_get(&dev->rbtx, &t)) {
+            dev->tx_busy = 1;
+            UART_REG16(dev->baseAddress, OFS_UCAxTXBUF) = t;
+            // the counter is shared with the ISR
+            state = __get_interrupt_state();
+            __disable_interrupt();
+            dev->stats.tx_bytes++;
+            __set_interrupt_state(state);
+        }
+    }
+}
+
+uint16_t uart_tx_str(uart_t * dev, const char *str, const uint16_t size)
+{
+    uint16_t p = 0;
+
+    while (p < size) {
+        p += ringbuf_put_n(&dev->rbtx, (const uint8_t *) str + p, size - p);
+        uart_tx_activate(dev);
+    }
+    return p;
+}
+
+uint16_t uart_print(uart_t * dev, const char *str)
+{
+    return uart_tx_str(dev, str, strlen(str));
+}
+
+#ifdef CONFIG_FMT
+static void uart_fmt_sink(void *ctx, const char *str, const uint16_t len)
+{
+    uart_tx_str((uart_t *) ctx, str, len);
+}
+
+uint16_t uart_printf(uart_t * dev, const char *format, ...)
+{
+    va_list ap;
+    uint16_t ret;
+
+    va_start(ap, format);
+    ret = fmt_vprintf(uart_fmt_sink, dev, format, ap);
+    va_end(ap);
+    return ret;
+}
+#endif
+
+// common interrupt handler. always inlined into the per-instance ISRs below
+// so that base is a constant and every register access is a direct one
+static inline __attribute__ ((always_inline))
+uint8_t uart_isr(uart_t * dev, const uint16_t base)
+{
+    uint8_t c;
+    uint8_t ev = 0;
+    uint16_t statw;
+
+    dev->stats.isr_cnt++;
+
+    switch (UART_REG16(base, OFS_UCAxIV)) {
+    case USCI_UART_UCRXIFG:
+        statw = UART_REG16(base, OFS_UCAxSTATW);
+        if (statw & UCRXERR) {
+            // clear error flags by forcing a dummy read
+            c = UART_REG16(base, OFS_UCAxRXBUF);
+            UART_STATS_RX_ERR(dev->stats, statw);
+        } else {
+            c = UART_REG16(base, OFS_UCAxRXBUF);
+            dev->stats.rx_bytes++;
+            if (dev->rx_irq_handler != NULL) {
+                if (dev->rx_irq_handler(dev, c)) {
+                    ev |= UART_EV_RX;
+                }
+            }
+        }
+        break;
+    case USCI_UART_UCTXIFG:
+        if (ringbuf_get(&dev->rbtx, &c)) {
+            dev->tx_busy = 1;
+            UART_REG16(base, OFS_UCAxTXBUF) = c;
+            dev->stats.tx_bytes++;
+        } else {
+            // nothing more to do
+            dev->tx_busy = 0;
+        }
+        break;
+    default:
+        break;
+    }
+
+    dev->last_event |= ev;
+    return ev;
+}
+
+#ifdef UART_USES_UCA0
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_A0_VECTOR
+__interrupt void USCI_A0_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_A0_VECTOR))) USCI_A0_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (uart_isr(&uart_a0, EUSCI_A0_BASE)) {
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+#endif
+
+#ifdef UART_USES_UCA1
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_A1_VECTOR
+__interrupt void USCI_A1_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_A1_VECTOR))) USCI_A1_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (uart_isr(&uart_a1, EUSCI_A1_BASE)) {
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+#endif
+
+#ifdef UART_USES_UCA2
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_A2_VECTOR
+__interrupt void USCI_A2_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_A2_VECTOR))) USCI_A2_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (uart_isr(&uart_a2, EUSCI_A2_BASE)) {
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+#endif
+
+#ifdef UART_USES_UCA3
+#if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
+#pragma vector=EUSCI_A3_VECTOR
+__interrupt void USCI_A3_ISR(void)
+#elif defined(__GNUC__)
+void __attribute__ ((interrupt(EUSCI_A3_VECTOR))) USCI_A3_ISR(void)
+#else
+#error Compiler not supported!
+#endif
+{
+    if (uart_isr(&uart_a3, EUSCI_A3_BASE)) {
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+// unified interrupt driven driver for the eUSCI_A UART modules
+//
+// every enabled eUSCI_A instance is represented by a uart_t descriptor that holds its
+// base address, its RX and TX ring buffers, the RX handler, the pending events and the
+// statistics. all instances share the same code, but each has its own ISR that passes a
+// constant base address to the common handler, so in the interrupt path all register
+// accesses are resolved at compile time.
+//
+// define UART_USES_UCA0 .. UART_USES_UCA3 in config.h for every instance that should be
+// handled by this driver. an instance must not also be used via uart0.c or uart1.c since
+// they would define the same interrupt vector.
+//
+// license:     BSD
+
+#ifndef __UART_H__
+#define __UART_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+#include "ringbuf.h"
+#include "uart_config.h"
+
+#define  UART_EV_NULL 0
+#define    UART_EV_RX 0x1
+#define    UART_EV_TX 0x2
+
+typedef struct uart_descriptor {
+    uint16_t baseAddress;       // EUSCI_Ax_BASE
+    struct ringbuf rbrx;
+    struct ringbuf rbtx;
+    // called from the ISR for every received byte, return 1 to wake up the main loop
+    uint8_t (*rx_irq_handler) (struct uart_descriptor * dev, const uint8_t c);
+    volatile uint8_t tx_busy;
+    volatile uint8_t last_event;
+    struct uart_stats stats;
+} uart_t;
+
+#ifdef UART_USES_UCA0
+extern uart_t uart_a0;
+#endif
+#ifdef UART_USES_UCA1
+extern uart_t uart_a1;
+#endif
+#ifdef UART_USES_UCA2
+extern uart_t uart_a2;
+#endif
+#ifdef UART_USES_UCA3
+extern uart_t uart_a3;
+#endif
+
+/*!
+	\brief initialize an eUSCI_A instance
+    \details the baud rate is the BAUD_ define from config.h (ACLK based 9600 if none is set).
+             the buffer sizes must be powers of two and at most 256 bytes.
+             the rx handler defaults to uart_rx_ringbuf_handler(). pins must be set up separately
+	\param dev    one of uart_a0 .. uart_a3
+*/
+void uart_init(uart_t * dev, uint8_t * rx_buf, const uint16_t rx_sz, uint8_t * tx_buf,
+               const uint16_t tx_sz);
+
+/*!
+	\brief queue size bytes for transmission
+    \details blocks only while the TX ring buffer is full
+	\return number of bytes queued
+*/
+uint16_t uart_tx_str(uart_t * dev, const char *str, const uint16_t size);
+
+/*!
+	\brief queue a zero terminated string for transmission
+*/
+uint16_t uart_print(uart_t * dev, const char *str);
+
+/*!
+	\brief format a string straight into the TX ring buffer
+    \details needs CONFIG_FMT, see fmt.h for the supported conversions
+	\return number of characters queued
+*/
+uint16_t uart_printf(uart_t * dev, const char *format, ...);
+
+/*!
+	\brief change the baud rate of an initialized port
+    \details the divisors are calculated by uart_baud_calc(). the port keeps the clock source
+             selected by uart_init() (UCSSELx), so clk has to be the frequency of that clock.
+             the transmitter should be idle
+	\param clk   BRCLK frequency in Hz, SMCLK_FREQ unless the port runs from ACLK
+	\param baud  baud rate
+	\return EXIT_SUCCESS or EXIT_FAILURE if the rate can not be generated from clk
+*/
+uint8_t uart_set_baud(uart_t * dev, const uint32_t clk, const uint32_t baud);
+
+/*!
+	\brief take a consistent snapshot of the statistics of a port
+*/
+void uart_get_stats(uart_t * dev, struct uart_stats *s);
+
+/*!
+	\brief clear the statistics of a port
+*/
+void uart_rst_stats(uart_t * dev);
+
+uint8_t uart_get_event(uart_t * dev);
+void uart_rst_event(uart_t * dev);
+struct ringbuf *uart_get_rx_ringbuf(uart_t * dev);
+void uart_set_rx_irq_handler(uart_t * dev, uint8_t (*input) (uart_t * dev, const uint8_t c));
+
+/*!
+	\brief default rx handler, stores bytes in the RX ring buffer and wakes up the main loop on 0x0d
+*/
+uint8_t uart_rx_ringbuf_handler(uart_t * dev, const uint8_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,7 @@
 
 #include <msp430.h>
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "config.h"
@@ -8,9 +9,66 @@
 #include "uart_config.h"
 #include "uart0.h"
 #include "ringbuf.h"
+#ifdef CONFIG_AUTOBAUD
+#include "autobaud.h"
+#endif
+#ifdef CONFIG_FMT
+#include <stdarg.h>
+#include "fmt.h"
+#endif
 
 #include "proj.h"
 
+#ifdef UART0_TX_USES_DMA
+// the DMA transmit path hands out regions of the same tx ring buffer
+#ifndef CONFIG_DMA
+#error "UART0_TX_USES_DMA needs CONFIG_DMA"
+#endif
+#ifndef UART0_TX_USES_IRQ
+#define UART0_TX_USES_IRQ
+#endif
+#include "driverlib.h"
+#include "dma.h"
+
+#ifndef UART0_TX_DMA_CH
+#define UART0_TX_DMA_CH  0
+#endif
+#ifndef UART0_TX_DMA_TSEL
+#define UART0_TX_DMA_TSEL  15   // UCA0TXIFG, see 'DMA Trigger Assignments' in the datasheet
+#endif
+#endif
+
+#if defined(UART0_TX_EVID) && defined(UART0_TX_USES_IRQ)
+#include "event_handler.h"
+#endif
+
+#ifdef UART0_RX_USES_DMA
+// the DMA receive path fills the rx ring buffer directly
+#ifndef CONFIG_DMA
+#error "UART0_RX_USES_DMA needs CONFIG_DMA"
+#endif
+#ifndef CONFIG_EH_TIMER
+#error "UART0_RX_USES_DMA needs CONFIG_EH_TIMER for the inter-byte timeout"
+#endif
+#ifndef UART0_RX_USES_RINGBUF
+#define UART0_RX_USES_RINGBUF
+#endif
+#include "driverlib.h"
+#include "dma.h"
+#include "eh_timer.h"
+#include "event_handler.h"
+
+#ifndef UART0_RX_DMA_CH
+#define UART0_RX_DMA_CH  1
+#endif
+#ifndef UART0_RX_DMA_TSEL
+#define UART0_RX_DMA_TSEL  14   // UCA0RXIFG, see 'DMA Trigger Assignments' in the datasheet
+#endif
+#ifndef UART0_RX_DMA_TIMEOUT
+#define UART0_RX_DMA_TIMEOUT  2 // inter-byte timeout in EH_TIMER_TICK units
+#endif
+#endif
+
 static uint8_t (*uart0_rx_irq_handler)(const uint8_t c);
 static uint8_t (*uart0_tx_irq_handler)(void);
 
@@ -28,9 +86,30 @@ struct ringbuf rbrx;
 struct ringbuf rbtx;
 uint8_t uart0_tx_buf[UART0_TXBUF_SZ];     // receive buffer
 volatile uint8_t uart0_tx_busy;
+static volatile uint8_t uart0_tx_lowat_armed;  // a short non-blocking write waits for UART0_EV_TX
+
+#ifndef UART0_TX_LOWAT
+#define UART0_TX_LOWAT  (UART0_TXBUF_SZ / 4)
+#endif
+#endif
+
+#ifdef UART0_TX_USES_DMA
+static volatile uint16_t uart0_tx_dma_len;     // size of the block currently handled by the DMA
+static volatile uint8_t uart0_tx_waiting;      // main loop sleeps until there is room in rbtx
+static uint8_t uart0_tx_dma_handler(const uint8_t ch);
+#endif
+
+#ifdef UART0_RX_USES_DMA
+static uint16_t uart0_rx_dma_pending;   // bytes received since the last UART0_EV_RX
+static volatile uint16_t uart0_rx_cnt;  // bytes reported by the last UART0_EV_RX
+static volatile uint8_t uart0_rx_dma_wraps;     // times the channel went back to the start of uart0_rx_buf
+static volatile uint8_t uart0_rx_dma_timer = EH_TIMER_INVALID;  // poll timer, only runs while data is arriving
+static uint8_t uart0_rx_dma_wrap_handler(const uint8_t ch);
+static void uart0_rx_dma_poll(const uint8_t id);
 #endif
 
 volatile uint8_t uart0_last_event;
+static struct uart_stats uart0_stats;
 
 
 
@@ -64,6 +143,14 @@ void uart0_init(void)
     UCA0BRW = BRW_115200_BAUD;
     UCA0MCTLW = MCTLW_115200_BAUD;
 
+    #elif defined(BAUD_230400)
+    UCA0BRW = BRW_230400_BAUD;
+    UCA0MCTLW = MCTLW_230400_BAUD;
+
+    #elif defined(BAUD_460800)
+    UCA0BRW = BRW_460800_BAUD;
+    UCA0MCTLW = MCTLW_460800_BAUD;
+
     #endif
 
 #else
@@ -77,79 +164,101 @@ void uart0_init(void)
 
 #ifdef UART0_TX_USES_IRQ
     ringbuf_init(&rbtx, uart0_tx_buf, UART0_TXBUF_SZ);
-    UCA0IE |= UCRXIE | UCTXIE;           // Enable USCI_A0 interrupts
+#ifdef UART0_TX_USES_DMA
+    // the DMA channel moves the bytes, UCTXIFG is only used as its trigger
+    DMA_REG16(UART0_TX_DMA_CH, OFS_DMA0CTL) = 0;
+    dma_set_trigger(UART0_TX_DMA_CH, UART0_TX_DMA_TSEL);
+    dma_set_irq_handler(UART0_TX_DMA_CH, uart0_tx_dma_handler);
+    DMA_REG16(UART0_TX_DMA_CH, OFS_DMA0DA) = (uintptr_t) &UCA0TXBUF;
+    DMA_REG16(UART0_TX_DMA_CH, OFS_DMA0CTL) =
+        DMADT_0 | DMASRCINCR_3 | DMADSTINCR_0 | DMASRCBYTE | DMADSTBYTE | DMAIE;
+    uart0_tx_dma_len = 0;
+    uart0_tx_waiting = 0;
+#else
+    UCA0IE |= UCTXIE;
+#endif
     //UCA0IE |= UCRXIE;           // Enable USCI_A0 RX interrupt
     //UCA0IE |= UCTXIE;
     //UCA0IFG &= ~UCTXIFG;
     uart0_tx_busy = 0;
-#else
+    uart0_tx_lowat_armed = 0;
+#endif
+
+#ifndef UART0_RX_USES_DMA
     UCA0IE |= UCRXIE;           // Enable USCI_A0 RX interrupt
 #endif
 
     uart0_p = 0;
     uart0_rx_enable = 1;
     uart0_rx_err = 0;
+    memset(&uart0_stats, 0, sizeof(struct uart_stats));
 
 #ifdef UART0_RX_USES_RINGBUF
     ringbuf_init(&rbrx, uart0_rx_buf, UART0_RXBUF_SZ);
 #endif
 
+#ifdef UART0_RX_USES_DMA
+    uart0_rx_dma_init();
+#endif
+
     //uart0_set_rx_irq_handler(uart0_rx_simple_handler);
 }
 
 void uart0_initb(const uint8_t baudrate)
 {
-    UCA3CTLW0 = UCSWRST;        // put eUSCI state machine in reset
-
-    // consult 'Recommended Settings for Typical Crystals and Baud Rates' in slau367o
-    // for some reason any baud >= 115200 ends up with a non-working RX channel
-
-    switch (baudrate) {
-#if defined(BAUD_9600)
-        case BAUDRATE_9600:
-            UCA0CTLW0 |= UC_CTLW0;
-            UCA0BRW = BRW_9600_BAUD;
-            UCA0MCTLW = MCTLW_9600_BAUD;
-            break;
-#endif
-#if defined(BAUD_19200)
-        case BAUDRATE_19200:
-            UCA0CTLW0 |= UC_CTLW0;
-            UCA0BRW = BRW_19200_BAUD;
-            UCA0MCTLW = MCTLW_19200_BAUD;
-            break;
-#endif
-#if defined(BAUD_38400)
-        case BAUDRATE_38400:
-            UCA0CTLW0 |= UC_CTLW0;
-            UCA0BRW = BRW_38400_BAUD;
-            UCA0MCTLW = MCTLW_38400_BAUD;
-            break;
-#endif
-#if defined(BAUD_19200)
-        case BAUDRATE_57600:
-            UCA0CTLW0 |= UC_CTLW0;
-            UCA0BRW = BRW_57600_BAUD;
-            UCA0MCTLW = MCTLW_57600_BAUD;
-            break;
-#endif
-#if defined(BAUD_115200)
-        case BAUDRATE_115200:
-            UCA0CTLW0 |= UC_CTLW0;
-            UCA0BRW = BRW_115200_BAUD;
-            UCA0MCTLW = MCTLW_115200_BAUD;
-            break;
-#endif
-    }
+    uint16_t ie = UCA0IE;
 
-    UCA0CTLW0 &= ~UCSWRST;      // Initialize eUSCI
-    UCA0IE |= UCRXIE;           // Enable USCI_A3 RX interrupt
+    // the rate is calculated for SMCLK and uart0_set_baud() keeps the clock source
+    UCA0CTLW0 = (UCA0CTLW0 & ~UCSSEL_3) | UCSSEL__SMCLK | UCSWRST;
+    uart0_set_baud(SMCLK_FREQ, uart_baud_get_rate(baudrate));
+    UCA0IE = ie;
+#ifndef UART0_RX_USES_DMA
+    UCA0IE |= UCRXIE;           // Enable USCI_A0 RX interrupt
+#endif
 
     uart0_p = 0;
     uart0_rx_enable = 1;
     uart0_rx_err = 0;
 }
 
+#ifdef CONFIG_AUTOBAUD
+// wait for the remote end to send 0x55 and switch to the detected rate
+uint8_t uart0_autobaud(const uint16_t timeout)
+{
+    uint8_t id;
+
+    id = autobaud_get_id(autobaud_measure(timeout));
+    if (id) {
+        uart0_initb(id);
+    }
+    return id;
+}
+#endif
+
+// switch to any baud rate based on a BRCLK of clk Hz, the clock source is not changed
+// make sure the transmitter is idle, a byte in flight is lost
+uint8_t uart0_set_baud(const uint32_t clk, const uint32_t baud)
+{
+    struct uart_baud b;
+    uint16_t ie, ctlw0;
+
+    if (uart_baud_calc(clk, baud, &b) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    // the clock source and the frame format stay as they are, like uart_set_baud().
+    // the interrupt enable bits are cleared while the eUSCI is in reset
+    ie = UCA0IE;
+    ctlw0 = UCA0CTLW0 & ~UCSWRST;
+    UCA0CTLW0 = ctlw0 | UCSWRST;        // put eUSCI state machine in reset
+    UCA0BRW = b.brw;
+    UCA0MCTLW = b.mctlw;
+    UCA0CTLW0 = ctlw0;          // Initialize eUSCI
+    UCA0IE = ie;
+
+    return EXIT_SUCCESS;
+}
+
 // default port locations
 void uart0_port_init(void)
 {
@@ -170,7 +279,9 @@ uint8_t uart0_rx_ringbuf_handler(const uint8_t c)
     if (!ringbuf_put(&rbrx, c)) {
         // the ringbuffer is full
         uart0_rx_err++;
+        UART_STATS_INC16(uart0_stats.rx_drop);
     }
+    UART_STATS_RX_PEAK(uart0_stats, ringbuf_elements(&rbrx));
 
     if (c == 0x0d) {
         return 1;
@@ -179,6 +290,19 @@ uint8_t uart0_rx_ringbuf_handler(const uint8_t c)
     return 0;
 }
 
+// same, but wake up the main loop at the 0x00 delimiter of a frame (see frame.h)
+uint8_t uart0_rx_frame_handler(const uint8_t c)
+{
+    if (!ringbuf_put(&rbrx, c)) {
+        // the ringbuffer is full
+        uart0_rx_err++;
+        UART_STATS_INC16(uart0_stats.rx_drop);
+    }
+    UART_STATS_RX_PEAK(uart0_stats, ringbuf_elements(&rbrx));
+
+    return (c == 0);
+}
+
 #else
 uint8_t uart0_rx_simple_handler(const uint8_t c)
 {
@@ -198,9 +322,14 @@ uint8_t uart0_rx_simple_handler(const uint8_t c)
         } else {
             uart0_rx_buf[uart0_p] = c;
             uart0_p++;
+            UART_STATS_RX_PEAK(uart0_stats, uart0_p);
         }
     } else {
-        uart0_rx_err++;
+        // saturate, a wrap to 0 would end the error state before the next 0x0d
+        if (uart0_rx_err != 0xff) {
+            uart0_rx_err++;
+        }
+        UART_STATS_INC16(uart0_stats.rx_drop);
         uart0_p = 0;
         if (c == 0x0d) {
             uart0_rx_err = 0;
@@ -217,12 +346,165 @@ uint8_t uart0_rx_simple_handler(const uint8_t c)
 }
 #endif
 
+#ifdef UART0_RX_USES_DMA
+
+// the channel copies every received byte straight into uart0_rx_buf, which
+// is the storage of rbrx. the repeated transfer wraps around on its own, the
+// DMA interrupt only counts the wraps so that an overrun by a whole buffer can
+// be told apart from no data at all. the poll timer is started by the start
+// bit of the first byte (UCSTTIFG) and stops again once the line is idle
+void uart0_rx_dma_init(void)
+{
+    uint16_t state;
+
+    DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0CTL) = 0;
+    dma_set_trigger(UART0_RX_DMA_CH, UART0_RX_DMA_TSEL);
+    dma_set_irq_handler(UART0_RX_DMA_CH, uart0_rx_dma_wrap_handler);
+    DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0SA) = (uintptr_t) &UCA0RXBUF;
+    DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0DA) = (uintptr_t) uart0_rx_buf;
+    DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0SZ) = UART0_RXBUF_SZ;
+    DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0CTL) =
+        DMADT_4 | DMASRCINCR_0 | DMADSTINCR_3 | DMASRCBYTE | DMADSTBYTE | DMAIE | DMAEN;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    if (uart0_rx_dma_timer != EH_TIMER_INVALID) {
+        eh_timer_cancel(uart0_rx_dma_timer);
+        uart0_rx_dma_timer = EH_TIMER_INVALID;
+    }
+    uart0_rx_dma_wraps = 0;
+    uart0_rx_dma_pending = 0;
+    uart0_rx_cnt = 0;
+    UCA0IFG &= ~UCSTTIFG;
+    UCA0IE |= UCSTTIE;
+    __set_interrupt_state(state);
+}
+
+// runs in the DMA ISR every time DMAxSZ reaches 0 and is reloaded
+static uint8_t uart0_rx_dma_wrap_handler(const uint8_t ch)
+{
+    if (uart0_rx_dma_wraps != 0xff) {
+        uart0_rx_dma_wraps++;
+    }
+    return 0;
+}
+
+// runs from the main loop UART0_RX_DMA_TIMEOUT ticks after the previous poll
+// or after the start bit that ended an idle period
+static void uart0_rx_dma_poll(const uint8_t id)
+{
+    uint16_t pos, len, c;
+    uint16_t ctl, sz;
+    uint16_t space;
+    uint16_t state;
+    uint8_t wraps;
+    uint8_t eol = 0;
+
+    // one-shot timer, the id has already been released
+    uart0_rx_dma_timer = EH_TIMER_INVALID;
+
+    // DMAxSZ and the wrap count are read as a pair. a wrap the DMA ISR has
+    // not seen yet is taken over here, the loop catches one that happens in between
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    do {
+        ctl = DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0CTL);
+        sz = DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0SZ);
+    } while ((ctl ^ DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0CTL)) & DMAIFG);
+    wraps = uart0_rx_dma_wraps;
+    if (ctl & DMAIFG) {
+        DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0CTL) &= ~DMAIFG;
+        wraps++;
+    }
+    uart0_rx_dma_wraps = 0;
+    __set_interrupt_state(state);
+
+    // DMAxSZ counts down the bytes left until the channel wraps back to the start of the buffer
+    pos = (UART0_RXBUF_SZ - sz) & (UART0_RXBUF_SZ - 1);
+    len = (pos - rbrx.put_ptr) & (UART0_RXBUF_SZ - 1);
+    space = (uint16_t) rbrx.mask + 1 - 1 - ringbuf_elements(&rbrx);
+
+    // put_ptr is where the channel was at the previous poll. more than one wrap,
+    // or a wrap that got back to or past put_ptr, means at least a whole buffer
+    if ((wraps > 1) || (wraps && (pos >= rbrx.put_ptr)) || (len > space)) {
+        // the DMA has overwritten bytes that were not read yet, neither the old
+        // nor the new contents can be trusted. drop both and resync with the channel
+        uart0_rx_err++;
+        UART_STATS_INC16(uart0_stats.rx_drop);
+        rbrx.get_ptr = pos;
+        rbrx.put_ptr = pos;
+        uart0_rx_dma_pending = 0;
+    } else if (len) {
+        for (c = 0; c < len; c++) {
+            if (uart0_rx_buf[(rbrx.put_ptr + c) & (UART0_RXBUF_SZ - 1)] == 0x0d) {
+                eol = 1;
+            }
+        }
+        ringbuf_commit(&rbrx, len);
+        uart0_rx_dma_pending += len;
+        uart0_stats.rx_bytes += len;
+        UART_STATS_RX_PEAK(uart0_stats, ringbuf_elements(&rbrx));
+    }
+
+    // report on a terminator or once the line has been idle for a whole poll period
+    if (uart0_rx_dma_pending && (eol || !len)) {
+        uart0_rx_cnt = uart0_rx_dma_pending;
+        uart0_rx_dma_pending = 0;
+        uart0_last_event |= UART0_EV_RX;
+#ifdef UART0_RX_EVID
+        eh_post(UART0_RX_EVID);
+#endif
+    }
+
+    __disable_interrupt();
+    if (len || uart0_rx_dma_pending) {
+        uart0_rx_dma_timer = eh_timer_start(uart0_rx_dma_poll, UART0_RX_DMA_TIMEOUT, 0);
+    } else {
+        // the line is idle, hand over to the start bit interrupt. a byte whose
+        // start bit came before the flag was cleared shows up as UCBUSY or as
+        // a DMAxSZ change, keep polling in that case
+        UCA0IFG &= ~UCSTTIFG;
+        if ((UCA0STATW & UCBUSY) || (DMA_REG16(UART0_RX_DMA_CH, OFS_DMA0SZ) != sz)) {
+            uart0_rx_dma_timer = eh_timer_start(uart0_rx_dma_poll, UART0_RX_DMA_TIMEOUT, 0);
+        } else {
+            UCA0IE |= UCSTTIE;
+        }
+    }
+    __set_interrupt_state(state);
+}
+
+uint16_t uart0_get_rx_cnt(void)
+{
+    return uart0_rx_cnt;
+}
+
+#endif
 
 void uart0_set_tx_irq_handler(uint8_t (*output)(void))
 {
     uart0_tx_irq_handler = output;
 }
 
+void uart0_get_stats(struct uart_stats *s)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    memcpy(s, &uart0_stats, sizeof(struct uart_stats));
+    __set_interrupt_state(state);
+}
+
+void uart0_rst_stats(void)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    memset(&uart0_stats, 0, sizeof(struct uart_stats));
+    __set_interrupt_state(state);
+}
+
 uint8_t uart0_get_event(void)
 {
     return uart0_last_event;
@@ -256,14 +538,115 @@ struct ringbuf *uart0_get_rx_ringbuf(void)
 #endif
 
 #ifdef UART0_TX_USES_IRQ
+struct ringbuf *uart0_get_tx_ringbuf(void)
+{
+    return &rbtx;
+}
+
+// returns 1 if a UART0_EV_TX has to be raised, called with interrupts disabled
+static inline uint8_t uart0_tx_lowat_check(void)
+{
+    if (uart0_tx_lowat_armed && (ringbuf_elements(&rbtx) <= UART0_TX_LOWAT)) {
+        uart0_tx_lowat_armed = 0;
+#ifdef UART0_TX_EVID
+        eh_post(UART0_TX_EVID);
+#endif
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef UART0_TX_USES_DMA
+
+// start a DMA block transfer out of the largest contiguous region of rbtx
+void uart0_tx_activate()
+{
+    uint8_t *ptr;
+    uint16_t len;
+    uint16_t state;
+
+    // called both from the main loop and from the DMA ISR
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    if (!uart0_tx_busy) {
+        len = ringbuf_read_span(&rbtx, &ptr);
+        if (len) {
+            uart0_tx_busy = 1;
+            uart0_tx_dma_len = len;
+            DMA_REG16(UART0_TX_DMA_CH, OFS_DMA0SA) = (uintptr_t) ptr;
+            DMA_REG16(UART0_TX_DMA_CH, OFS_DMA0SZ) = len;
+            DMA_REG16(UART0_TX_DMA_CH, OFS_DMA0CTL) |= DMAEN;
+            // the trigger is edge sensitive. while the eUSCI is idle UCTXIFG is
+            // already set, so toggle it to get the first byte out. otherwise
+            // TXBUF still holds the last byte of the previous block and the
+            // next UCTXIFG edge starts the transfer on its own
+            if (UCA0IFG & UCTXIFG) {
+                UCA0IFG &= ~UCTXIFG;
+                UCA0IFG |= UCTXIFG;
+            }
+        }
+    }
+    __set_interrupt_state(state);
+}
+
+// runs in the DMA ISR once a block has been sent
+static uint8_t uart0_tx_dma_handler(const uint8_t ch)
+{
+    uint8_t wake = uart0_tx_waiting;
+
+    ringbuf_consume(&rbtx, uart0_tx_dma_len);
+    uart0_stats.tx_bytes += uart0_tx_dma_len;
+    uart0_tx_dma_len = 0;
+    uart0_tx_busy = 0;
+    // the data after the wrap point (or added meanwhile) goes out as the next block
+    uart0_tx_activate();
+    uart0_tx_waiting = 0;
+    if (uart0_tx_lowat_check()) {
+        uart0_last_event |= UART0_EV_TX;
+        wake = 1;
+    }
+    return wake;
+}
+
+uint16_t uart0_tx_str(const char *str, const uint16_t size)
+{
+    uint16_t p = 0;
+    uint16_t state;
+
+    while (p < size) {
+        p += ringbuf_put_n(&rbtx, (const uint8_t *) str + p, size - p);
+        uart0_tx_activate();
+        if (p < size) {
+            // rbtx is full, sleep until the DMA has freed the current block
+            state = __get_interrupt_state();
+            __disable_interrupt();
+            if (uart0_tx_busy) {
+                uart0_tx_waiting = 1;
+                __bis_SR_register(LPM0_bits | GIE);
+                __no_operation();
+            }
+            __set_interrupt_state(state);
+        }
+    }
+    return p;
+}
+
+#else
+
 void uart0_tx_activate()
 {
     uint8_t t;
+    uint16_t state;
 
     if (!uart0_tx_busy) {
         if (ringbuf_get(&rbtx, &t)) {
             uart0_tx_busy = 1;
             UCA0TXBUF = t;
+            // the counter is shared with the ISR
+            state = __get_interrupt_state();
+            __disable_interrupt();
+            uart0_stats.tx_bytes++;
+            __set_interrupt_state(state);
         }
     }
 }
@@ -272,34 +655,47 @@ uint16_t uart0_tx_str(const char *str, const uint16_t size)
 {
     uint16_t p = 0;
 
-    while (p < size) {        
-        if (ringbuf_put(&rbtx, str[p])) {
-            p++;
-        }
-        if (p == 1) {
-            uart0_tx_activate();
-        }
+    while (p < size) {
+        p += ringbuf_put_n(&rbtx, (const uint8_t *) str + p, size - p);
+        uart0_tx_activate();
     }
-    //uart0_tx_activate();
     return p;
 }
 
+#endif
+
 uint16_t uart0_print(const char *str)
 {
-    size_t p = 0;
-    size_t size = strlen(str);
-    while (p < size) {
-        if (ringbuf_put(&rbtx, str[p])) {
-            p++;
-        }
-        if (p == 1) {
-            uart0_tx_activate();
+    return uart0_tx_str(str, strlen(str));
+}
+
+uint16_t uart0_tx_str_nb(const char *str, const uint16_t size)
+{
+    uint16_t p;
+    uint16_t state;
+
+    p = ringbuf_put_n(&rbtx, (const uint8_t *) str, size);
+    uart0_tx_activate();
+
+    if (p < size) {
+        // ask for a UART0_EV_TX once rbtx has drained below the low-water mark
+        state = __get_interrupt_state();
+        __disable_interrupt();
+        uart0_tx_lowat_armed = 1;
+        // the buffer might have drained before the flag was set
+        if (uart0_tx_lowat_check()) {
+            uart0_last_event |= UART0_EV_TX;
         }
+        __set_interrupt_state(state);
     }
-    //uart0_tx_activate();
     return p;
 }
 
+uint16_t uart0_print_nb(const char *str)
+{
+    return uart0_tx_str_nb(str, strlen(str));
+}
+
 #else
 uint16_t uart0_tx_str(const char *str, const uint16_t size)
 {
@@ -308,6 +704,7 @@ uint16_t uart0_tx_str(const char *str, const uint16_t size)
         while (!(UCA0IFG & UCTXIFG)) {
         }                       // USCI_A0 TX buffer ready?
         UCA0TXBUF = str[p];
+        uart0_stats.tx_bytes++;
         p++;
     }
     return p;
@@ -321,12 +718,37 @@ uint16_t uart0_print(const char *str)
         while (!(UCA0IFG & UCTXIFG)) {
         }                       // USCI_A0 TX buffer ready?
         UCA0TXBUF = str[p];
+        uart0_stats.tx_bytes++;
         p++;
     }
     return p;
 }
 #endif
 
+// output callback compatible with frame_enc_begin()
+void uart0_tx_sink(void *ctx, const uint8_t *data, const uint16_t len)
+{
+    uart0_tx_str((const char *)data, len);
+}
+
+#ifdef CONFIG_FMT
+static void uart0_fmt_sink(void *ctx, const char *str, const uint16_t len)
+{
+    uart0_tx_str(str, len);
+}
+
+uint16_t uart0_printf(const char *format, ...)
+{
+    va_list ap;
+    uint16_t ret;
+
+    va_start(ap, format);
+    ret = fmt_vprintf(uart0_fmt_sink, NULL, format, ap);
+    va_end(ap);
+    return ret;
+}
+#endif
+
 #if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
 #pragma vector=EUSCI_A0_VECTOR
 __interrupt void USCI_A0_ISR(void)
@@ -339,18 +761,24 @@ void __attribute__ ((interrupt(EUSCI_A0_VECTOR))) USCI_A0_ISR(void)
     uint16_t iv = UCA0IV;
     register char r;
     uint8_t ev = 0;
-#ifdef UART0_TX_USES_IRQ
+    uint16_t statw;
+#if defined(UART0_TX_USES_IRQ) && !defined(UART0_TX_USES_DMA)
     uint8_t t;
     //int16_t rb;
 #endif
 
+    uart0_stats.isr_cnt++;
+
     switch (iv) {
     case USCI_UART_UCRXIFG:
-        if (UCA0STATW & UCRXERR) {
+        statw = UCA0STATW;
+        if (statw & UCRXERR) {
             // clear error flags by forcing a dummy read
             r = UCA0RXBUF;
+            UART_STATS_RX_ERR(uart0_stats, statw);
         } else {
             r = UCA0RXBUF;
+            uart0_stats.rx_bytes++;
             if (uart0_rx_irq_handler != NULL) {
                 if (uart0_rx_irq_handler(r)) {
                     ev |= UART0_EV_RX;
@@ -360,16 +788,31 @@ void __attribute__ ((interrupt(EUSCI_A0_VECTOR))) USCI_A0_ISR(void)
         }
         break;
     case USCI_UART_UCTXIFG:
-#ifdef UART0_TX_USES_IRQ
+#if defined(UART0_TX_USES_IRQ) && !defined(UART0_TX_USES_DMA)
         if (ringbuf_get(&rbtx, &t)) {
             uart0_tx_busy = 1;
             UCA0TXBUF = t;
+            uart0_stats.tx_bytes++;
         } else {
             // nothing more to do
             uart0_tx_busy = 0;
         }
+        if (uart0_tx_lowat_check()) {
+            ev |= UART0_EV_TX;
+            LPM3_EXIT;
+        }
 #endif
         break;
+#ifdef UART0_RX_USES_DMA
+    case USCI_UART_UCSTTIFG:
+        // first byte after an idle period, poll the DMA until the line is quiet again
+        // reading UCA0IV cleared the flag, so if no timer is free the next byte tries again
+        uart0_rx_dma_timer = eh_timer_start(uart0_rx_dma_poll, UART0_RX_DMA_TIMEOUT, 0);
+        if (uart0_rx_dma_timer != EH_TIMER_INVALID) {
+            UCA0IE &= ~UCSTTIE;
+        }
+        break;
+#endif
     default:
         break;
     }
@@ -11,18 +11,49 @@ extern "C" {
 
 void uart0_init(void);
 void uart0_initb(const uint8_t baudrate);
+// the port keeps its clock source (UCSSELx), clk is the frequency of that clock
+uint8_t uart0_set_baud(const uint32_t clk, const uint32_t baud);
+
+// CONFIG_AUTOBAUD - detect the rate from a 0x55 sent by the remote end and apply it
+// timeout is in units of 65536 SMCLK cycles. returns the BAUDRATE_ id or 0 if nothing was detected
+uint8_t uart0_autobaud(const uint16_t timeout);
 void uart0_port_init(void);
 uint16_t uart0_tx_str(const char *str, const uint16_t size);
 uint16_t uart0_print(const char *str);
 
+// CONFIG_FMT - format straight into the tx ringbuf (or the TX register in polled mode), see fmt.h
+uint16_t uart0_printf(const char *format, ...);
+
+// non-blocking variants (UART0_TX_USES_IRQ)
+// copy as much as fits into the tx ringbuf and return the number of bytes taken.
+// after a short write UART0_EV_TX is raised once the buffer drains below
+// UART0_TX_LOWAT bytes (default a quarter of UART0_TXBUF_SZ)
+uint16_t uart0_tx_str_nb(const char *str, const uint16_t size);
+uint16_t uart0_print_nb(const char *str);
+
 uint16_t uart0_tx_str2(const char *str, const uint16_t size);
 uint16_t uart0_print2(const char *str);
 
+// traffic and error counters, see struct uart_stats in uart_config.h
+struct uart_stats;
+void uart0_get_stats(struct uart_stats *s);
+void uart0_rst_stats(void);
+
 uint8_t uart0_get_event(void);
 void uart0_rst_event(void);
 void uart0_set_eol(void);
 char *uart0_get_rx_buf(void);
 struct ringbuf *uart0_get_rx_ringbuf(void);
+struct ringbuf *uart0_get_tx_ringbuf(void);
+
+// DMA receive mode (UART0_RX_USES_DMA)
+// bytes land in the rx ringbuf without an interrupt per byte. UART0_EV_RX is raised
+// once a 0x0d arrives or the line stays idle for UART0_RX_DMA_TIMEOUT timer ticks,
+// uart0_get_rx_cnt() then returns the number of bytes that came in with that event.
+// the poll timer only runs between the first start bit and the end of the burst. if
+// the DMA overwrites unread bytes the whole buffer is dropped and counted in rx_drop.
+void uart0_rx_dma_init(void);
+uint16_t uart0_get_rx_cnt(void);
 
 void uart0_set_rx_irq_handler(uint8_t (*input)(const uint8_t c));
 void uart0_set_tx_irq_handler(uint8_t (*output)(void));
@@ -30,6 +61,11 @@ void uart0_set_tx_irq_handler(uint8_t (*output)(void));
 // sample inside-irq handlers
 uint8_t uart0_rx_simple_handler(const uint8_t rx);
 uint8_t uart0_rx_ringbuf_handler(const uint8_t c);
+uint8_t uart0_rx_frame_handler(const uint8_t c);
+
+// binary frames (frame.h) go out via
+//   frame_enc_begin(&enc, uart0_tx_sink, NULL);
+void uart0_tx_sink(void *ctx, const uint8_t *data, const uint16_t len);
 
 
 #ifdef __cplusplus
@@ -4,8 +4,10 @@
 #include <string.h>
 #include "uart1.h"
 
-// get the UART1_SPEED_ #define
+// get the UART1_BAUD or UART1_SPEED_ #define
 #include "config.h"
+#include "clock.h"
+#include "uart_config.h"
 
 volatile char uart1_rx_buf[UART1_RXBUF_SZ];     // receive buffer
 volatile uint8_t uart1_p;       // number of characters received, 0 if none
@@ -13,6 +15,7 @@ volatile uint8_t uart1_rx_enable;
 volatile uint8_t uart1_rx_err;
 
 volatile uint8_t uart1_last_event;
+static struct uart_stats uart1_stats;
 
 // you'll have to initialize/map uart ports in main()
 // or use uart1_port_init() if no mapping is needed
@@ -23,7 +26,12 @@ void uart1_init(void)
     // consult 'Recommended Settings for Typical Crystals and Baud Rates' in slau367o
     // for some reason any baud >= 115200 ends up with a non-working RX channel
 
-#ifdef UART1_SPEED_9600_1M
+#if defined (UART1_BAUD)
+    // any rate, the divisors are calculated at compile time
+    UCA1CTLW0 |= UCSSEL__SMCLK;
+    UCA1BRW = UART_BAUD_BRW(SMCLK_FREQ, UART1_BAUD);
+    UCA1MCTLW = UART_BAUD_MCTLW(SMCLK_FREQ, UART1_BAUD);
+#elif defined (UART1_SPEED_9600_1M)
     UCA1CTLW0 |= UCSSEL__SMCLK;
     UCA1BRW = 6;
     UCA1MCTLW = 0x2081;
@@ -84,6 +92,7 @@ void uart1_init(void)
     uart1_p = 0;
     uart1_rx_enable = 1;
     uart1_rx_err = 0;
+    memset(&uart1_stats, 0, sizeof(struct uart_stats));
 }
 
 // default port locations
@@ -93,6 +102,26 @@ void uart1_port_init(void)
     P2SEL1 |= (BIT0 | BIT1);
 }
 
+void uart1_get_stats(struct uart_stats *s)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    memcpy(s, &uart1_stats, sizeof(struct uart_stats));
+    __set_interrupt_state(state);
+}
+
+void uart1_rst_stats(void)
+{
+    uint16_t state;
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    memset(&uart1_stats, 0, sizeof(struct uart_stats));
+    __set_interrupt_state(state);
+}
+
 uint8_t uart1_get_event(void)
 {
     return uart1_last_event;
@@ -125,6 +154,7 @@ uint16_t uart1_tx_str(const char *str, const uint16_t size)
         while (!(UCA1IFG & UCTXIFG)) {
         }                       // USCI_A1 TX buffer ready?
         UCA1TXBUF = str[p];
+        uart1_stats.tx_bytes++;
         p++;
     }
     return p;
@@ -138,6 +168,7 @@ uint16_t uart1_print(const char *str)
         while (!(UCA1IFG & UCTXIFG)) {
         }                       // USCI_A1 TX buffer ready?
         UCA1TXBUF = str[p];
+        uart1_stats.tx_bytes++;
         p++;
     }
     return p;
@@ -155,10 +186,20 @@ void __attribute__ ((interrupt(EUSCI_A1_VECTOR))) USCI_A1_ISR(void)
     uint16_t iv = UCA1IV;
     register char rx;
     uint8_t ev = 0;
+    uint16_t statw;
+
+    uart1_stats.isr_cnt++;
 
     switch (iv) {
     case USCI_UART_UCRXIFG:
+        statw = UCA1STATW;
         rx = UCA1RXBUF;
+        if (statw & UCRXERR) {
+            // the read above cleared the error flags, drop the byte
+            UART_STATS_RX_ERR(uart1_stats, statw);
+            break;
+        }
+        uart1_stats.rx_bytes++;
 
         if (rx == 0x0a) {
             return;
@@ -176,9 +217,14 @@ void __attribute__ ((interrupt(EUSCI_A1_VECTOR))) USCI_A1_ISR(void)
             } else {
                 uart1_rx_buf[uart1_p] = rx;
                 uart1_p++;
+                UART_STATS_RX_PEAK(uart1_stats, uart1_p);
             }
         } else {
-            uart1_rx_err++;
+            // saturate, a wrap to 0 would end the error state before the next 0x0d
+            if (uart1_rx_err != 0xff) {
+                uart1_rx_err++;
+            }
+            UART_STATS_INC16(uart1_stats.rx_drop);
             uart1_p = 0;
             if (rx == 0x0d) {
                 uart1_rx_err = 0;
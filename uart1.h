@@ -15,6 +15,11 @@ void uart1_init();
 void uart1_port_init(void);
 uint16_t uart1_tx_str(const char *str, const uint16_t size);
 uint16_t uart1_print(const char *str);
+// traffic and error counters, see struct uart_stats in uart_config.h
+struct uart_stats;
+void uart1_get_stats(struct uart_stats *s);
+void uart1_rst_stats(void);
+
 uint8_t uart1_get_event(void);
 void uart1_rst_event(void);
 void uart1_set_eol(void);
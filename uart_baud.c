@@ -0,0 +1,99 @@
+// eUSCI_A baud rate generator settings
+//
+// license:     BSD
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include "uart_config.h"
+#include "uart_baud.h"
+
+// slau367p table 30-4, fractional portion of N (in 1/10000 units) and the matching UCBRSx
+static const uint16_t uart_baud_frac[] = {
+    529, 715, 835, 1001, 1252, 1430, 1670, 2147, 2224, 2503, 3000, 3335, 3575, 3753,
+    4003, 4286, 4378, 5002, 5715, 6003, 6254, 6432, 6667, 7001, 7147, 7503, 7861, 8004,
+    8333, 8464, 8572, 8751, 9004, 9170, 9288
+};
+
+static const uint8_t uart_baud_ucbrs[] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x11, 0x21, 0x22, 0x44, 0x25, 0x49, 0x4a, 0x52,
+    0x92, 0x53, 0x55, 0xaa, 0x6b, 0xad, 0xb5, 0xb6, 0xd6, 0xb7, 0xbb, 0xdd, 0xed, 0xee,
+    0xbf, 0xdf, 0xef, 0xf7, 0xfb, 0xfd, 0xfe
+};
+
+uint8_t uart_baud_calc(const uint32_t clk, const uint32_t baud, struct uart_baud *b)
+{
+    uint32_t n;
+    uint16_t frac;
+    uint8_t ucbrs = 0;
+    uint8_t c;
+    uint8_t os16;
+    uint16_t brf = 0;
+    uint32_t cycles = 0;
+    int32_t diff;
+    uint16_t err;
+
+    if ((baud == 0) || (clk < baud * 3)) {
+        return EXIT_FAILURE;
+    }
+
+    n = clk / baud;
+    frac = UART_BAUD_FRAC(clk, baud);
+
+    for (c = 0; c < sizeof(uart_baud_frac) / sizeof(uart_baud_frac[0]); c++) {
+        if (frac < uart_baud_frac[c]) {
+            break;
+        }
+        ucbrs = uart_baud_ucbrs[c];
+    }
+
+    os16 = (n >= 16);
+    if (os16) {
+        b->brw = n >> 4;
+        brf = n & 0xf;
+    } else {
+        b->brw = n;
+    }
+    b->mctlw = ((uint16_t) ucbrs << 8) | (brf << 4) | os16;
+
+    // simulate the start bit, 8 data bits and the stop bit. the UCBRSx pattern
+    // is applied MSB first, one bit of the pattern for each bit on the line
+    b->err = 0;
+    for (c = 0; c < 10; c++) {
+        if (os16) {
+            cycles += 16 * b->brw + brf;
+        } else {
+            cycles += b->brw;
+        }
+        cycles += (ucbrs >> (7 - (c & 0x7))) & 0x1;
+
+        // deviation of the end of this bit from the ideal position, in 0.01% of a bit
+        diff = (int32_t) (cycles * baud - (uint32_t) (c + 1) * clk);
+        err = labs(diff * 100 / (int32_t) (clk / 100));
+        if (err > b->err) {
+            b->err = err;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+uint32_t uart_baud_get_rate(const uint8_t baudrate)
+{
+    switch (baudrate) {
+    case BAUDRATE_9600:
+        return 9600;
+    case BAUDRATE_19200:
+        return 19200;
+    case BAUDRATE_38400:
+        return 38400;
+    case BAUDRATE_57600:
+        return 57600;
+    case BAUDRATE_115200:
+        return 115200;
+    case BAUDRATE_230400:
+        return 230400;
+    case BAUDRATE_460800:
+        return 460800;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+// eUSCI_A baud rate generator settings
+//
+// computes UCBRx, UCBRFx, UCBRSx and UCOS16 for any BRCLK frequency and baud rate
+// following 'Baud-Rate Settings' in slau367p.pdf (30.3.10):
+//
+//   N = f_BRCLK / baud
+//   N >= 16: UCOS16 = 1, UCBRx = INT(N/16), UCBRFx = INT(((N/16) - INT(N/16)) * 16)
+//   N <  16: UCOS16 = 0, UCBRx = INT(N)
+//   UCBRSx is taken from table 30-4 based on the fractional part of N
+//
+// UART_BAUD_BRW() and UART_BAUD_MCTLW() fold into constants when both arguments are
+// known at compile time, uart_baud_calc() does the same at run time and also reports
+// the worst case transmit bit error.
+//
+// license:     BSD
+
+#ifndef __UART_BAUD_H__
+#define __UART_BAUD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+// fractional part of clk/baud in 1/10000 units, calculated without 32bit overflows
+#define UART_BAUD_FRAC(clk, baud)  \
+    ((((((clk) % (baud)) * 100UL) / (baud)) * 100UL) + \
+     (((((clk) % (baud)) * 100UL) % (baud)) * 100UL) / (baud))
+
+// slau367p table 30-4, UCBRSx settings for the fractional portion of N
+#define UART_BAUD_UCBRS(frac)  \
+    ((frac) >= 9288 ? 0xfe : (frac) >= 9170 ? 0xfd : (frac) >= 9004 ? 0xfb : \
+     (frac) >= 8751 ? 0xf7 : (frac) >= 8572 ? 0xef : (frac) >= 8464 ? 0xdf : \
+     (frac) >= 8333 ? 0xbf : (frac) >= 8004 ? 0xee : (frac) >= 7861 ? 0xed : \
+     (frac) >= 7503 ? 0xdd : (frac) >= 7147 ? 0xbb : (frac) >= 7001 ? 0xb7 : \
+     (frac) >= 6667 ? 0xd6 : (frac) >= 6432 ? 0xb6 : (frac) >= 6254 ? 0xb5 : \
+     (frac) >= 6003 ? 0xad : (frac) >= 5715 ? 0x6b : (frac) >= 5002 ? 0xaa : \
+     (frac) >= 4378 ? 0x55 : (frac) >= 4286 ? 0x53 : (frac) >= 4003 ? 0x92 : \
+     (frac) >= 3753 ? 0x52 : (frac) >= 3575 ? 0x4a : (frac) >= 3335 ? 0x49 : \
+     (frac) >= 3000 ? 0x25 : (frac) >= 2503 ? 0x44 : (frac) >= 2224 ? 0x22 : \
+     (frac) >= 2147 ? 0x21 : (frac) >= 1670 ? 0x11 : (frac) >= 1430 ? 0x20 : \
+     (frac) >= 1252 ? 0x10 : (frac) >= 1001 ? 0x08 : (frac) >= 835 ? 0x04 : \
+     (frac) >= 715 ? 0x02 : (frac) >= 529 ? 0x01 : 0x00)
+
+// UCAxBRW - clock prescaler
+#define UART_BAUD_BRW(clk, baud)  \
+    ((uint16_t) (((clk) / (baud) >= 16) ? (clk) / (baud) / 16 : (clk) / (baud)))
+
+// UCAxMCTLW - UCBRSx << 8 | UCBRFx << 4 | UCOS16
+#define UART_BAUD_MCTLW(clk, baud)  \
+    ((uint16_t) ((UART_BAUD_UCBRS(UART_BAUD_FRAC(clk, baud)) << 8) | \
+     (((clk) / (baud) >= 16) ? (((((clk) / (baud)) % 16) << 4) | 0x1) : 0)))
+
+struct uart_baud {
+    uint16_t brw;               // UCAxBRW
+    uint16_t mctlw;             // UCAxMCTLW
+    uint16_t err;               // worst case transmit bit error in 0.01% units
+};
+
+/*!
+	\brief calculate the baud rate generator settings
+	\param clk   BRCLK frequency in Hz
+	\param baud  baud rate
+	\param b     output
+	\return EXIT_SUCCESS or EXIT_FAILURE if the clock is slower than three times the baud rate
+*/
+uint8_t uart_baud_calc(const uint32_t clk, const uint32_t baud, struct uart_baud *b);
+
+/*!
+	\brief convert one of the BAUDRATE_ constants from uart_config.h into a baud rate
+	\return baud rate or 0 for an unknown value
+*/
+uint32_t uart_baud_get_rate(const uint8_t baudrate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
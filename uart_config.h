@@ -1,138 +1,82 @@
 #ifndef __UART_CONFIG_H__
 #define __UART_CONFIG_H__
 
+#include <inttypes.h>
+#include "uart_baud.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#if defined(BAUD_9600)
 #define        BAUDRATE_9600  0x1
-#endif
-#if defined(BAUD_19200)
 #define       BAUDRATE_19200  0x2
-#endif
-#if defined(BAUD_38400)
 #define       BAUDRATE_38400  0x3
-#endif
-#if defined(BAUD_57600)
 #define       BAUDRATE_57600  0x4
-#endif
-#if defined(BAUD_115200)
 #define      BAUDRATE_115200  0x5
-#endif
+#define      BAUDRATE_230400  0x6
+#define      BAUDRATE_460800  0x7
+
+// traffic and error counters kept by every uart driver
+// the 16bit counters saturate instead of wrapping around
+struct uart_stats {
+    uint32_t rx_bytes;          // bytes received without error
+    uint32_t tx_bytes;          // bytes written to the TX register (or handed to the DMA)
+    uint32_t isr_cnt;           // number of times the eUSCI ISR was entered
+    uint16_t rx_err_frame;      // bytes discarded due to a framing error (UCFE)
+    uint16_t rx_err_parity;     // bytes discarded due to a parity error (UCPE)
+    uint16_t rx_err_overrun;    // overrun errors (UCOE), the previous byte was lost
+    uint16_t rx_drop;           // bytes lost because the RX buffer was full
+    uint16_t rx_peak;           // highest RX buffer occupancy seen
+};
+
+#define UART_STATS_INC16(cnt)  do { if ((cnt) != 0xffff) { (cnt)++; } } while (0)
+
+// classify an error based on the contents of UCAxSTATW
+#define UART_STATS_RX_ERR(s, statw)  do { \
+    if ((statw) & UCFE) { UART_STATS_INC16((s).rx_err_frame); } \
+    if ((statw) & UCPE) { UART_STATS_INC16((s).rx_err_parity); } \
+    if ((statw) & UCOE) { UART_STATS_INC16((s).rx_err_overrun); } \
+} while (0)
+
+#define UART_STATS_RX_PEAK(s, cnt)  do { if ((cnt) > (s).rx_peak) { (s).rx_peak = (cnt); } } while (0)
 
 #define             UART0_RX_NO_ERR  0x0
 #define          UART0_RX_WAKE_MAIN  0x1 // ringbuffer got a special value, wake up main loop
 #define             UART0_RX_ERR_RB  0x2 // ringbuffer is full, cannot add new element
 
-// values based on slau367p.pdf table 30-5 Typical Crystals and Baud Rates
+// values calculated by uart_baud.h based on slau367p.pdf 30.3.10 Setting a Baud Rate
+// use uart_baud_calc() to get the worst case bit error of a given combination
 
 // UCAxBRW.UCBRx - clock prescaler (16bit)
 // UCAxMCTLW - 16bit modulation control word register (16bit)
 //                     UCBRSx - second modulation stage select - 8bit
 // UCBRFX - first modulation stage select - 4 bit | reserved - 3 bit | UCOS16 - 1 bit
 
-#if SMCLK_FREQ == 1000000
-
-#define             UC_CTLW0  UCSSEL__SMCLK
-
-// err                        -0.48  0.64  -1.04  1.04
-#define        BRW_9600_BAUD  6
-#define      MCTLW_9600_BAUD  0x2081
-
-// err                        -0.8  0.96  -1.84  1.84
-#define       BRW_19200_BAUD  3
-#define     MCTLW_19200_BAUD  0x2041
-
-// err                        0  1.76  0  3.44
-#define       BRW_38400_BAUD  1
-#define     MCTLW_38400_BAUD  0x00a1
-
-// err                        -2.72  2.56  -3.76  7.28
-#define       BRW_57600_BAUD  17
-#define     MCTLW_57600_BAUD  0x4a00
-
-// err                        -7.36  5.6  -17.04  6.96
-#define      BRW_115200_BAUD  8
-#define    MCTLW_115200_BAUD  0xd600
-
-
-#elif SMCLK_FREQ == 4000000
+#ifdef SMCLK_FREQ
 
 #define             UC_CTLW0  UCSSEL__SMCLK
 
-// err                        -0.08  0.16  -0.28  0.2
-#define        BRW_9600_BAUD  26
-#define      MCTLW_9600_BAUD  0xb601
-
-// err                        -0.32  0.32  -0.64  0.48
-#define       BRW_19200_BAUD  13
-#define     MCTLW_19200_BAUD  0x8401
+#define        BRW_9600_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 9600UL)
+#define      MCTLW_9600_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 9600UL)
 
-// err                        -0.48  0.64  -1.04  1.04
-#define       BRW_38400_BAUD  6
-#define     MCTLW_38400_BAUD  0x2081
-
-// err                        -0.8  0.64  -1.12  1.76
-#define       BRW_57600_BAUD  4
-#define     MCTLW_57600_BAUD  0x5551
-
-// err                        -1.44  1.28  -3.92  1.68
-#define      BRW_115200_BAUD  2
-#define    MCTLW_115200_BAUD  0xbb21
-
-
-#elif SMCLK_FREQ == 8000000
-
-#define             UC_CTLW0  UCSSEL__SMCLK
-
-// err                        -0.08  0.04  -0.1  0.14
-#define        BRW_9600_BAUD  52
-#define      MCTLW_9600_BAUD  0x4911
-
-// err                        -0.08  0.16  -0.28  0.2
-#define       BRW_19200_BAUD  26
-#define     MCTLW_19200_BAUD  0xb601
-
-// err                        -0.32  0.32  -0.64  0.48
-#define       BRW_38400_BAUD  13
-#define     MCTLW_38400_BAUD  0x8401
-
-// err                        -0.32  0.32  -1.00  0.36
-#define       BRW_57600_BAUD  8
-#define     MCTLW_57600_BAUD  0xf7a1
-
-// err                        -0.80  0.64  -1.12  1.76
-#define      BRW_115200_BAUD  4
-#define    MCTLW_115200_BAUD  0x5551
-
-
-#elif SMCLK_FREQ == 16000000
-
-#define             UC_CTLW0  UCSSEL__SMCLK
+#define       BRW_19200_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 19200UL)
+#define     MCTLW_19200_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 19200UL)
 
-// err                        -0.04  0.02  -0.09  0.03
-#define        BRW_9600_BAUD  104
-#define      MCTLW_9600_BAUD  0xd621
+#define       BRW_38400_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 38400UL)
+#define     MCTLW_38400_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 38400UL)
 
-// err                        -0.08  0.04  -0.10  0.14
-#define       BRW_19200_BAUD  52
-#define     MCTLW_19200_BAUD  0x4911
+#define       BRW_57600_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 57600UL)
+#define     MCTLW_57600_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 57600UL)
 
-// err                        -0.08  0.16  -0.28  0.20
-#define       BRW_38400_BAUD  26
-#define     MCTLW_38400_BAUD  0xb601
+#define      BRW_115200_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 115200UL)
+#define    MCTLW_115200_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 115200UL)
 
-// err                        -0.16  0.20  -0.30  0.38
-#define       BRW_57600_BAUD  17
-#define     MCTLW_57600_BAUD  0xdd51
+#define      BRW_230400_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 230400UL)
+#define    MCTLW_230400_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 230400UL)
 
-// err                        -0.32  0.32  -1.00  0.36
-#define      BRW_115200_BAUD  8
-#define    MCTLW_115200_BAUD  0xf7a1
+#define      BRW_460800_BAUD  UART_BAUD_BRW(SMCLK_FREQ, 460800UL)
+#define    MCTLW_460800_BAUD  UART_BAUD_MCTLW(SMCLK_FREQ, 460800UL)
 
-#else
-    #error SMCLK_FREQ is not defined or sourced from clock.h
 #endif
 
 